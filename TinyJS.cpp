@@ -44,6 +44,15 @@
 #include <errno.h>
 #include <sstream>
 #include <fstream>
+#include <stdio.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#	include <sys/mman.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
 
 #include "TinyJS.h"
 
@@ -66,6 +75,11 @@
 #	include <cmath>
 #	include <memory>
 #endif
+#ifdef HAVE_CXX_THREADS
+#	include <exception>
+#	include <mutex>
+#	include <thread>
+#endif
 
 using namespace std;
 
@@ -126,12 +140,45 @@ void show_allocated() {
 /// Utils
 //////////////////////////////////////////////////////////////////////////
 
+// the character classes of the lexer - one table lookup instead of a chain of compares
+enum {
+	CH_SPACE	= 1<<0,	///< ' ' '\t'
+	CH_LINE	= 1<<1,	///< '\n' '\r'
+	CH_ALPHA	= 1<<2,	///< a-z A-Z _ $
+	CH_DIGIT	= 1<<3,	///< 0-9
+	CH_HEX	= 1<<4,	///< 0-9 a-f A-F
+	CH_OCT	= 1<<5,	///< 0-7
+};
+#define S CH_SPACE
+#define L CH_LINE
+#define A CH_ALPHA
+#define D CH_DIGIT
+#define X CH_HEX
+#define O CH_OCT
+static const unsigned char charClass[256] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, S, L, 0, 0, L, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	S, 0, 0, 0, A, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	D|X|O, D|X|O, D|X|O, D|X|O, D|X|O, D|X|O, D|X|O, D|X|O, D|X, D|X, 0, 0, 0, 0, 0, 0,
+	0, A|X, A|X, A|X, A|X, A|X, A|X, A, A, A, A, A, A, A, A, A,
+	A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, A,
+	0, A|X, A|X, A|X, A|X, A|X, A|X, A, A, A, A, A, A, A, A, A,
+	A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,
+	// 0x80-0xFF: 0
+};
+#undef S
+#undef L
+#undef A
+#undef D
+#undef X
+#undef O
+
 inline bool isWhitespace(char ch) {
-	return (ch==' ') || (ch=='\t') || (ch=='\n') || (ch=='\r');
+	return (charClass[(unsigned char)ch] & (CH_SPACE|CH_LINE)) != 0;
 }
 
 inline bool isNumeric(char ch) {
-	return (ch>='0') && (ch<='9');
+	return (charClass[(unsigned char)ch] & CH_DIGIT) != 0;
 }
 uint32_t isArrayIndex(const string &str) {
 	if(str.size()==0 || !isNumeric(str[0]) || (str.size()>1 && str[0]=='0') ) return -1; // empty or (more as 1 digit and beginning with '0')
@@ -142,13 +189,13 @@ uint32_t isArrayIndex(const string &str) {
 	return idx.toUInt32();
 }
 inline bool isHexadecimal(char ch) {
-	return ((ch>='0') && (ch<='9')) || ((ch>='a') && (ch<='f')) || ((ch>='A') && (ch<='F'));
+	return (charClass[(unsigned char)ch] & CH_HEX) != 0;
 }
 inline bool isOctal(char ch) {
-	return ((ch>='0') && (ch<='7'));
+	return (charClass[(unsigned char)ch] & CH_OCT) != 0;
 }
 inline bool isAlpha(char ch) {
-	return ((ch>='a') && (ch<='z')) || ((ch>='A') && (ch<='Z')) || ch=='_' || ch=='$';
+	return (charClass[(unsigned char)ch] & CH_ALPHA) != 0;
 }
 
 bool isIDString(const char *s) {
@@ -258,6 +305,16 @@ CScriptLex::CScriptLex(const char *Code, const string &File, int Line, int Colum
 	pos.currentLine = Line;
 	reset(pos);
 }
+CScriptLex::~CScriptLex() {
+	for(map<string, CScriptTokenDataString*>::iterator it=atoms.begin(); it!=atoms.end(); ++it)
+		it->second->unref();
+}
+
+CScriptTokenDataString *CScriptLex::tkAtom() {
+	CScriptTokenDataString *&atom = atoms[tkStr];
+	if(!atom) (atom = new CScriptTokenDataString(tkStr))->ref(); // a reference is held by the lexer
+	return atom;
+}
 
 void CScriptLex::reset(const POS &toPos) { ///< Reset this lex so we can start again
 	dataPos = toPos.tokenStart;
@@ -306,36 +363,59 @@ void CScriptLex::getNextCh() {
 	}
 }
 
+void CScriptLex::setPos(const char *Pos) {
+	dataPos = Pos;
+	currCh = nextCh = 0;
+	getNextCh(); // currCh
+	getNextCh(); // nextCh
+}
+
+const char *CScriptLex::skipNewLine(const char *Pos) {
+	if(*Pos++ == '\r' && *Pos == '\n') Pos++; // Windows '\r\n' or Mac '\r'
+	pos.currentLine++;
+	pos.currentLineStart = Pos;
+	return Pos;
+}
+
 static uint16_t not_allowed_tokens_befor_regexp[] = {LEX_ID, LEX_INT, LEX_FLOAT, LEX_STR, LEX_R_TRUE, LEX_R_FALSE, LEX_R_NULL, ']', ')', '.', LEX_PLUSPLUS, LEX_MINUSMINUS, LEX_EOF};
 void CScriptLex::getNextToken() {
-	while (currCh && isWhitespace(currCh)) getNextCh();
-	// newline comments
-	if (currCh=='/' && nextCh=='/') {
-			while (currCh && currCh!='\n') getNextCh();
-			getNextCh();
-			getNextToken();
-			return;
-	}
-	// block comments
-	if (currCh=='/' && nextCh=='*') {
-			while (currCh && (currCh!='*' || nextCh!='/')) getNextCh();
-			getNextCh();
-			getNextCh();
-			getNextToken();
-			return;
+	// whitespace and comments are scanned directly in the source - strcspn is vectorized by most C libraries
+	const char *start = currentPos(), *p = start;
+	tokenEnd = start > data && *start == '\n' && start[-1] == '\r' ? start-1 : start; // currCh skipped the '\r' of "\r\n"
+	for(;;) {
+		unsigned char cls = charClass[(unsigned char)*p];
+		if(cls & CH_SPACE)
+			p++;
+		else if(cls & CH_LINE)
+			p = skipNewLine(p);
+		else if(*p=='/' && p[1]=='/') // newline comments
+			p += 2 + strcspn(p+2, "\r\n");
+		else if(*p=='/' && p[1]=='*') { // block comments
+			for(p += 2; ; ) {
+				p += strcspn(p, "*\r\n");
+				if(*p == '*') {
+					if(*++p == '/') { p++; break; }
+				} else if(*p)
+					p = skipNewLine(p);
+				else
+					break; // unterminated
+			}
+		} else
+			break;
 	}
+	if(p != start) setPos(p);
 	last_tk = tk;
 	tk = LEX_EOF;
 	tkStr.clear();
 	// record beginning of this token
-	pos.tokenStart = dataPos - (nextCh == LEX_EOF ? (currCh == LEX_EOF ? 0 : 1) : 2);
+	pos.tokenStart = currentPos();
 	// tokens
 	if (isAlpha(currCh)) { //  IDs
-		while (isAlpha(currCh) || isNumeric(currCh)) {
-			tkStr += currCh;
-			getNextCh();
-		}
-		tk = CScriptToken::isReservedWord(tkStr);
+		const char *end = pos.tokenStart;
+		while(charClass[(unsigned char)*++end] & (CH_ALPHA|CH_DIGIT));
+		tkStr.assign(pos.tokenStart, end);
+		setPos(end);
+		tk = CScriptToken::isReservedWord(pos.tokenStart, end-pos.tokenStart);
 #ifdef NO_GENERATORS
 		if(tk == LEX_R_YIELD)
 			throw new CScriptException(Error, "42TinyJS was built without support of generators (yield expression)", currentFile, pos.currentLine, currentColumn());
@@ -377,9 +457,14 @@ void CScriptLex::getNextToken() {
 		}
 	} else if (currCh=='"' || currCh=='\'') {	// strings...
 		char endCh = currCh;
+		const char stopChars[] = { endCh, '\\', '\r', '\n', 0 };
 		getNextCh();
 		while (currCh && currCh!=endCh && currCh!='\n') {
-			if (currCh == '\\') {
+			if (currCh != '\\') { // a run of plain characters
+				const char *begin = currentPos(), *end = begin + strcspn(begin, stopChars);
+				tkStr.append(begin, end);
+				setPos(end);
+			} else {
 				getNextCh();
 				switch (currCh) {
 					case '\n' : break; // ignore newline after '\'
@@ -395,12 +480,13 @@ void CScriptLex::getNextToken() {
 						if(isHexadecimal(currCh)) {
 							char buf[3]="\0\0";
 							buf[0] = currCh;
-							for(int i=0; i<2 && isHexadecimal(nextCh); i++) {
+							for(int i=1; i<2 && isHexadecimal(nextCh); i++) {
 								getNextCh(); buf[i] = currCh;
 							}
 							tkStr += (char)strtol(buf, 0, 16);
 						} else
 							throw new CScriptException(SyntaxError, "malformed hexadezimal character escape sequence", currentFile, pos.currentLine, currentColumn());	
+						break;
 					}
 					default: {
 						if(isOctal(currCh)) {
@@ -414,10 +500,8 @@ void CScriptLex::getNextToken() {
 						else tkStr += currCh;
 					}
 				}
-			} else {
-				tkStr += currCh;
+				getNextCh();
 			}
-			getNextCh();
 		}
 		if(currCh != endCh)
 			throw new CScriptException(SyntaxError, "unterminated string literal", currentFile, pos.currentLine, currentColumn());
@@ -600,6 +684,38 @@ std::string CScriptTokenDataForwards::addLets( STRING_VECTOR_t &Lets )
 	return "";
 }
 
+void CScriptTokenDataForwards::buildScopeTemplate() {
+	// all names are identifiers (no array indices) -> the string order of the sets is the order of the Childs
+	SLOT slot;
+	slot.fnc = 0;
+	letSlots.clear();
+	slot.flags = SCRIPTVARLINK_VARDEFAULT;
+	for(STRING_SET_it it=varNames[LETS].begin(); it!=varNames[LETS].end(); ++it) {
+		slot.name = *it;
+		letSlots.push_back(slot);
+	}
+	// a var wins over a const with the same name, a function takes the slot of a var or const
+	map<string, SLOT> slots;
+	for(int i=VARS; i<END; ++i) {
+		slot.flags = i==CONSTS ? SCRIPTVARLINK_CONSTDEFAULT : SCRIPTVARLINK_VARDEFAULT;
+		for(STRING_SET_it it=varNames[i].begin(); it!=varNames[i].end(); ++it) {
+			slot.name = *it;
+			slots.insert(make_pair(*it, slot));
+		}
+	}
+	slot.flags = SCRIPTVARLINK_VARDEFAULT;
+	for(FNC_SET_it it=functions.begin(); it!=functions.end(); ++it) {
+		slot.name = it->Fnc().name;
+		slot.fnc = &*it;
+		slots.insert(make_pair(slot.name, slot)).first->second.fnc = slot.fnc;
+	}
+	varSlots.clear();
+	varSlots.reserve(slots.size());
+	for(map<string, SLOT>::iterator it=slots.begin(); it!=slots.end(); ++it)
+		varSlots.push_back(it->second);
+	scopeTemplateReady = true;
+}
+
 
 //////////////////////////////////////////////////////////////////////////
 // CScriptTokenDataLoop
@@ -610,7 +726,7 @@ std::string CScriptTokenDataLoop::getParsableString(const string &IndentString/*
 	static const char *ops[] = {" in ", " in ", " of ", "; "};
 	string out = heads[type];
 	if(init.size() && type==FOR)out.append(CScriptToken::getParsableString(init));
-	if(type<=WHILE) out.append(CScriptToken::getParsableString(condition.begin(), condition.end()-(type>=FOR ? 0 : 7)));
+	if(type<=WHILE) out.append(CScriptToken::getParsableString(condition.begin(), condition.end()-(type>=FOR ? 0 : 3)));
 	if(type<=FOR) out.append(ops[type]);
 	if(iter.size()) out.append(CScriptToken::getParsableString(iter));
 	out.append(")");
@@ -642,10 +758,203 @@ std::string CScriptTokenDataTry::getParsableString( const string &IndentString/*
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+// CScriptTokenDataLiteral
+//////////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_CXX_THREADS
+static std::atomic<uint32_t> literalSerials(0);
+#else
+static uint32_t literalSerials = 0;
+#endif
+CScriptTokenDataLiteral::CScriptTokenDataLiteral() {
+	while((serial = ++literalSerials) == 0); // 0 marks a free slot of the literal cache
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 // CScriptTokenDataFnc
 //////////////////////////////////////////////////////////////////////////
 
+// pre-parse - lexes a function body from its '{' to the matching '}'
+// Names collects the identifiers (not behind a '.') like collectFreeNames
+static void scanFunctionBody(CScriptLex &Lexer, STRING_SET_t *Names=0, bool *UsesEval=0) {
+	int depth = 0;
+	do {
+		switch(Lexer.tk) {
+		case '{': depth++; break;
+		case '}': depth--; break;
+		case LEX_EOF: Lexer.match('}'); break; // throws
+		case LEX_ID:
+			if(Names && Lexer.last_tk != '.') {
+				if(Lexer.tkStr == "eval" || Lexer.tkStr == "require") *UsesEval = true;
+				Names->insert(Lexer.tkStr);
+			}
+		}
+		Lexer.match(Lexer.tk);
+	} while(depth);
+}
+
+static void resetToLazyBody(CScriptLex &Lexer, CScriptTokenDataFnc &Fnc) {
+	CScriptTokenDataFnc::LAZY_BODY &Lazy = *Fnc.getLazyBody();
+	const char *code = Lexer.getCode();
+	CScriptLex::POS pos;
+	pos.tokenStart = code + Lazy.begin;
+	pos.currentLineStart = code + Lazy.lineStart;
+	pos.currentLine = Lazy.line;
+	Lexer.reset(pos);
+}
+
+static void collectFreeNames(TOKEN_VECT &Tokens, STRING_SET_t &Names, vector<CScriptTokenDataFnc*> &Nested, bool &UsesEval);
+static void collectBodyNames(CScriptTokenDataFnc &Fnc, STRING_SET_t &Names, vector<CScriptTokenDataFnc*> &Nested, bool &UsesEval) {
+	if(Fnc.isLazy()) {
+		CScriptLex lexer(Fnc.source->code, Fnc.file);
+		resetToLazyBody(lexer, Fnc);
+		scanFunctionBody(lexer, &Names, &UsesEval);
+	} else
+		collectFreeNames(Fnc.body, Names, Nested, UsesEval);
+}
+
+// collects all identifiers used in Tokens (with the identifiers of nested functions)
+static void collectFreeNames(TOKEN_VECT &Tokens, STRING_SET_t &Names, vector<CScriptTokenDataFnc*> &Nested, bool &UsesEval) {
+	for(TOKEN_VECT_it it=Tokens.begin(); it!=Tokens.end(); ++it) {
+		int tk = it->token;
+		if(tk == LEX_ID) {
+			if(it != Tokens.begin() && (it-1)->token == '.') continue; // member name
+			const string &name = it->String();
+			if(name == "eval" || name == "require") UsesEval = true;
+			Names.insert(name);
+		} else if(LEX_TOKEN_DATA_FUNCTION(tk)) {
+			CScriptTokenDataFnc &Fnc = it->Fnc();
+			Nested.push_back(&Fnc);
+			collectFreeNames(Fnc.arguments, Names, Nested, UsesEval);
+			collectBodyNames(Fnc, Names, Nested, UsesEval);
+		} else if(LEX_TOKEN_DATA_LOOP(tk)) {
+			CScriptTokenDataLoop &Loop = it->Loop();
+			collectFreeNames(Loop.init, Names, Nested, UsesEval);
+			collectFreeNames(Loop.condition, Names, Nested, UsesEval);
+			collectFreeNames(Loop.iter, Names, Nested, UsesEval);
+			collectFreeNames(Loop.body, Names, Nested, UsesEval);
+		} else if(LEX_TOKEN_DATA_TRY(tk)) {
+			CScriptTokenDataTry &Try = it->Try();
+			collectFreeNames(Try.tryBlock, Names, Nested, UsesEval);
+			for(CScriptTokenDataTry::CatchBlock_it catchBlock=Try.catchBlocks.begin(); catchBlock!=Try.catchBlocks.end(); ++catchBlock) {
+				if(catchBlock->indentifiers) collectFreeNames(catchBlock->indentifiers->assignment, Names, Nested, UsesEval);
+				collectFreeNames(catchBlock->condition, Names, Nested, UsesEval);
+				collectFreeNames(catchBlock->block, Names, Nested, UsesEval);
+			}
+			collectFreeNames(Try.finallyBlock, Names, Nested, UsesEval);
+		} else if(LEX_TOKEN_DATA_OBJECT_LITERAL(tk)) {
+			CScriptTokenDataObjectLiteral &Objc = it->Object();
+			for(vector<CScriptTokenDataObjectLiteral::ELEMENT>::iterator element=Objc.elements.begin(); element!=Objc.elements.end(); ++element) {
+				if(element->value.empty()) Names.insert(element->id);
+				else collectFreeNames(element->value, Names, Nested, UsesEval);
+			}
+		} else if(LEX_TOKEN_DATA_DESTRUCTURING_VAR(tk)) {
+			collectFreeNames(it->DestructuringVar().assignment, Names, Nested, UsesEval);
+		} else if(LEX_TOKEN_DATA_FORWARDER(tk)) {
+			CScriptTokenDataForwards::FNC_SET_t &functions = it->Forwarder().functions;
+			for(CScriptTokenDataForwards::FNC_SET_it fnc=functions.begin(); fnc!=functions.end(); ++fnc) {
+				CScriptTokenDataFnc &Fnc = const_cast<CScriptToken&>(*fnc).Fnc();
+				Nested.push_back(&Fnc);
+				collectFreeNames(Fnc.arguments, Names, Nested, UsesEval);
+				collectBodyNames(Fnc, Names, Nested, UsesEval);
+			}
+		}
+	}
+}
+
+void CScriptTokenDataFnc::analyzeCapture() {
+	STRING_SET_t names;
+	vector<CScriptTokenDataFnc*> nested;
+	bool usesEval = false;
+	collectFreeNames(arguments, names, nested, usesEval);
+	collectBodyNames(*this, names, nested, usesEval); // a lazy body declares no names -> more names are captured as needed
+	if(usesEval) {
+		// eval can use and create any name -> this function and all nested functions needs the whole scope chain
+		capture = CAPTURE_SCOPE;
+		for(vector<CScriptTokenDataFnc*>::iterator it=nested.begin(); it!=nested.end(); ++it)
+			(*it)->capture = CAPTURE_SCOPE;
+		return;
+	}
+	// remove the names declared by the function itself
+	names.erase(name);
+	names.erase(TINYJS_ARGUMENTS_VAR);
+	if(isArrowFunction)
+		names.insert("this"); // also used implicit by calls
+	else
+		names.erase("this");
+	STRING_VECTOR_t argNames;
+	for(TOKEN_VECT_it it=arguments.begin(); it!=arguments.end(); ++it) {
+		if(it->token == LEX_ID) argNames.push_back(it->String());
+		else it->DestructuringVar().getVarNames(argNames);
+	}
+	for(STRING_VECTOR_it it=argNames.begin(); it!=argNames.end(); ++it)
+		names.erase(*it);
+	if(body.size() && body.front().token == LEX_T_FORWARD) {
+		CScriptTokenDataForwards &Forwarder = body.front().Forwarder();
+		for(int i=0; i<CScriptTokenDataForwards::END; ++i)
+			for(STRING_SET_it it=Forwarder.varNames[i].begin(); it!=Forwarder.varNames[i].end(); ++it)
+				names.erase(*it);
+		for(CScriptTokenDataForwards::FNC_SET_it it=Forwarder.functions.begin(); it!=Forwarder.functions.end(); ++it)
+			names.erase(it->Fnc().name);
+	}
+	captureNames.assign(names.begin(), names.end());
+	capture = CAPTURE_NAMES;
+}
+
+CScriptTokenDataFnc::~CScriptTokenDataFnc() {
+	delete getLazyBody();
+}
+
+static void prepareSharedTokens(TOKEN_VECT &Tokens);
+#ifdef HAVE_CXX_THREADS
+static std::mutex lazyBodyMutex;
+#endif
+void CScriptTokenDataFnc::tokenizeLazyBody() {
+#ifdef HAVE_CXX_THREADS
+	std::lock_guard<std::mutex> lock(lazyBodyMutex);
+	if(!isLazy()) return; // tokenized by another thread
+#endif
+	LAZY_BODY *Lazy = getLazyBody();
+	CScriptTokenizer tokenizer;
+	tokenizer.tokenizeLazyBody(*this); // a syntax error leaves the body lazy
+	if(capture == CAPTURE_SCOPE) { // eval is used -> the nested functions needs the whole scope chain too
+		STRING_SET_t names;
+		vector<CScriptTokenDataFnc*> nested;
+		bool usesEval = false;
+		collectFreeNames(body, names, nested, usesEval);
+		for(vector<CScriptTokenDataFnc*>::iterator it=nested.begin(); it!=nested.end(); ++it)
+			(*it)->capture = CAPTURE_SCOPE;
+	}
+	if(Lazy->shared) { // a CScript is immutable after the body is published
+		hasSimpleParameters();
+		prepareSharedTokens(body);
+	}
+	lazy = 0;
+	delete Lazy;
+}
+
+void CScriptTokenDataFnc::analyzeParameters() {
+	parameters = isGenerator ? PARAMETERS_COMPLEX : PARAMETERS_SIMPLE;
+	for(TOKEN_VECT_it it=arguments.begin(); parameters == PARAMETERS_SIMPLE && it!=arguments.end(); ++it) {
+		if(it->token == LEX_ID) {
+			paramNames.push_back(it->String());
+			continue;
+		}
+		CScriptTokenDataDestructuringVar &DestructuringVar = it->DestructuringVar();
+		if(DestructuringVar.vars.size() == 1 && DestructuringVar.assignment.empty()) {
+			const string &name = DestructuringVar.vars.front().second;
+			if(name.size() && name.find_first_of("{[]}") == string::npos) {
+				paramNames.push_back(name);
+				continue;
+			}
+		}
+		parameters = PARAMETERS_COMPLEX;
+	}
+	if(parameters == PARAMETERS_COMPLEX) paramNames.clear();
+}
+
 string CScriptTokenDataFnc::getArgumentsString( bool forArrowFunction/*=false*/ ) {
 	ostringstream destination;
 	if(!forArrowFunction || arguments.size()!=1)
@@ -757,6 +1066,42 @@ void CScriptTokenDataObjectLiteral::setMode(bool Destructuring) {
 	}
 }
 
+static bool boilerplateSlotLess(const CScriptTokenDataObjectLiteral::SLOT &lhs, const CScriptTokenDataObjectLiteral::SLOT &rhs) {
+	// same order as CScriptVarLinkPtr::operator < -> names first then array indices
+	uint32_t lhs_int = isArrayIndex(lhs.name);
+	uint32_t rhs_int = isArrayIndex(rhs.name);
+	if(lhs_int==uint32_t(-1))
+		return rhs_int==uint32_t(-1) ? lhs.name < rhs.name : true;
+	return rhs_int==uint32_t(-1) ? false : lhs_int < rhs_int;
+}
+void CScriptTokenDataObjectLiteral::buildBoilerplate() {
+	boilerplateState = BOILERPLATE_UNUSABLE;
+	vector<SLOT> slots;
+	slots.reserve(elements.size());
+	for(vector<ELEMENT>::iterator it=elements.begin(); it!=elements.end(); ++it) {
+		if(it->value.empty()) continue;
+		int token = it->value.front().token;
+		if(token==LEX_T_GET || token==LEX_T_SET) return;
+		SLOT slot;
+		slot.name = it->id;
+		slot.element = it - elements.begin();
+		slot.constToken = 0;
+		if(it->value.size()==1 && (token==LEX_INT || token==LEX_FLOAT || token==LEX_STR || token==LEX_R_TRUE || token==LEX_R_FALSE || token==LEX_R_NULL))
+			slot.constToken = token;
+		slots.push_back(slot);
+	}
+	stable_sort(slots.begin(), slots.end(), boilerplateSlotLess);
+	// duplicated names -> the last element wins
+	boilerplate.clear();
+	for(vector<SLOT>::iterator it=slots.begin(); it!=slots.end(); ++it) {
+		if(boilerplate.size() && boilerplate.back().name == it->name)
+			boilerplate.back() = *it;
+		else
+			boilerplate.push_back(*it);
+	}
+	boilerplateState = BOILERPLATE_READY;
+}
+
 string CScriptTokenDataObjectLiteral::getParsableString() {
 	string out = type == OBJECT ? "{ " : "[ ";
 	const char *comma = "";
@@ -837,8 +1182,12 @@ static token2str_t reserved_words_begin[] ={
 #define ARRAY_LENGTH(array) (sizeof(array)/sizeof(array[0]))
 #define ARRAY_END(array) (&array[ARRAY_LENGTH(array)])
 static token2str_t *reserved_words_end = ARRAY_END(reserved_words_begin);//&reserved_words_begin[ARRAY_LENGTH(reserved_words_begin)];
-static token2str_t *str2reserved_begin[sizeof(reserved_words_begin)/sizeof(reserved_words_begin[0])];
-static token2str_t **str2reserved_end = &str2reserved_begin[sizeof(str2reserved_begin)/sizeof(str2reserved_begin[0])];
+// a perfect hash of the reserved words - the first two characters and the length are unique
+#define RESERVED_WORDS_HASH_SIZE 64
+static inline size_t reservedWordHash(const char *Str, size_t Len) {
+	return ((unsigned char)Str[0] + (unsigned char)Str[1]*35 + Len*11) & (RESERVED_WORDS_HASH_SIZE-1);
+}
+static token2str_t *reserved_words_hash[RESERVED_WORDS_HASH_SIZE];
 static token2str_t tokens2str_begin[] = {
 	{ LEX_EOF,						"EOF",						false },
 	{ LEX_ID,						"ID",							true  },
@@ -883,6 +1232,7 @@ static token2str_t tokens2str_begin[] = {
 	{ LEX_T_LOOP,					"LEX_LOOP",					true  },
 	{ LEX_T_FOR_IN,				"LEX_FOR_IN",				true  },
 	{ LEX_T_FORWARD,				"LEX_T_FORWARD",			false  },
+	{ LEX_T_SWITCH_TABLE,		"LEX_T_SWITCH_TABLE",	false  },
 	{ LEX_T_OBJECT_LITERAL,		"LEX_OBJECT_LITERAL",	false  },
 	{ LEX_T_DESTRUCTURING_VAR,	"Destructuring Var",		false  },
 };
@@ -894,20 +1244,17 @@ struct token2str_cmp_t {
 	bool operator()(const token2str_t &lhs, int rhs) {
 		return lhs.id < rhs;
 	}
-	bool operator()(const token2str_t *lhs, const token2str_t *rhs) {
-		return strcmp(lhs->str, rhs->str)<0;
-	}
-	bool operator()(const token2str_t *lhs, const char *rhs) {
-		return strcmp(lhs->str, rhs)<0;
-	}
 };
 static bool tokens2str_sort() {
 //	printf("tokens2str_sort called\n");
 	sort(tokens2str_begin, tokens2str_end, token2str_cmp_t());
 	sort(reserved_words_begin, reserved_words_end, token2str_cmp_t());
-	for(unsigned int i=0; i<ARRAY_LENGTH(str2reserved_begin); i++)
-		str2reserved_begin[i] = &reserved_words_begin[i];
-	sort(str2reserved_begin, str2reserved_end, token2str_cmp_t());
+	memset(reserved_words_hash, 0, sizeof(reserved_words_hash));
+	for(token2str_t *it = reserved_words_begin; it != reserved_words_end; ++it) {
+		token2str_t *&slot = reserved_words_hash[reservedWordHash(it->str, strlen(it->str))];
+		ASSERT(slot == 0); // a new reserved word needs other factors in reservedWordHash
+		slot = it;
+	}
 	return true;
 }
 static bool tokens2str_sorted = tokens2str_sort();
@@ -919,11 +1266,11 @@ CScriptToken::CScriptToken(CScriptLex *l, int Match, int Alternate) : line(l->cu
 		if(number.isInfinity())
 			token=LEX_ID, (tokenData=new CScriptTokenDataString("Infinity"))->ref();
 		else if(number.isInt32())
-			token=LEX_INT, intData=number.toInt32();
+			token=LEX_INT, (tokenData=new CScriptTokenDataNumber(number.toInt32()))->ref();
 		else
-			token=LEX_FLOAT, floatData=new double(number.toDouble());
+			token=LEX_FLOAT, (tokenData=new CScriptTokenDataNumber(number.toDouble()))->ref();
 	} else if(LEX_TOKEN_DATA_STRING(token))
-		(tokenData = new CScriptTokenDataString(l->tkStr))->ref();
+		(tokenData = l->tkAtom())->ref();
 	else if(LEX_TOKEN_DATA_FUNCTION(token))
 		(tokenData = new CScriptTokenDataFnc)->ref();
 	else if (LEX_TOKEN_DATA_LOOP(token))
@@ -941,6 +1288,8 @@ CScriptToken::CScriptToken(CScriptLex *l, int Match, int Alternate) : line(l->cu
 CScriptToken::CScriptToken(uint16_t Tk, int IntData) : line(0), column(0), token(Tk), intData(0) {
 	if (LEX_TOKEN_DATA_SIMPLE(token))
 		intData = IntData;
+	else if (token == LEX_INT)
+		(tokenData = new CScriptTokenDataNumber(IntData))->ref();
 	else if (LEX_TOKEN_DATA_FUNCTION(token))
 		(tokenData = new CScriptTokenDataFnc)->ref();
 	else if (LEX_TOKEN_DATA_DESTRUCTURING_VAR(token))
@@ -953,6 +1302,8 @@ CScriptToken::CScriptToken(uint16_t Tk, int IntData) : line(0), column(0), token
 		(tokenData = new CScriptTokenDataTry)->ref();
 	else if (LEX_TOKEN_DATA_FORWARDER(token))
 		(tokenData = new CScriptTokenDataForwards)->ref();
+	else if (LEX_TOKEN_DATA_SWITCH_TABLE(token))
+		(tokenData = new CScriptTokenDataSwitchTable)->ref();
 	else 
 		ASSERT(0);
 #ifdef _DEBUG
@@ -985,9 +1336,7 @@ CScriptToken &CScriptToken::operator =(const CScriptToken &Copy)
 	line			= Copy.line;
 	column		= Copy.column; 
 	token			= Copy.token;
-	if(LEX_TOKEN_DATA_FLOAT(token))
-		floatData = new double(*Copy.floatData);
-	else if(!LEX_TOKEN_DATA_SIMPLE(token))
+	if(!LEX_TOKEN_DATA_SIMPLE(token))
 		(tokenData = Copy.tokenData)->ref();
 	else
 		intData	= Copy.intData;
@@ -1016,7 +1365,9 @@ string CScriptToken::getParsableString(TOKEN_VECT_it Begin, TOKEN_VECT_it End, c
 		else if(LEX_TOKEN_DATA_FLOAT(it->token))
 			OutString.append(CNumber(it->Float()).toString()), need_space=true;
 		else if(it->token == LEX_INT)
-			OutString.append(CNumber(it->Int()).toString()), need_space=true;
+			OutString.append(CNumber(it->Number().intData).toString()), need_space=true;
+		else if(LEX_TOKEN_DATA_FUNCTION(it->token) && it->Fnc().hasSourceString())
+			OutString.append(it->Fnc().getSourceString());
 		else if(LEX_TOKEN_DATA_FUNCTION(it->token)) {
 			bool isArrowFunction = it->Fnc().isArrowFunction;
 			if(!isArrowFunction)
@@ -1026,6 +1377,7 @@ string CScriptToken::getParsableString(TOKEN_VECT_it Begin, TOKEN_VECT_it End, c
 			OutString.append(it->Fnc().getArgumentsString(isArrowFunction));
 			if(isArrowFunction)
 				OutString.append("=> ");
+			it->Fnc().tokenizeBody();
 			OutString.append(getParsableString(it->Fnc().body, my_indentString, Indent));
 		} else if(LEX_TOKEN_DATA_LOOP(it->token)) {
 			OutString.append(it->Loop().getParsableString(my_indentString, Indent));
@@ -1048,8 +1400,8 @@ string CScriptToken::getParsableString(TOKEN_VECT_it Begin, TOKEN_VECT_it End, c
 			add_nl = true;
 		} else if(it->token == LEX_T_SKIP) {
 			// ignore SKIP-Token
-		} else if(it->token == LEX_T_FORWARD) {
-			// ignore Forwarder-Token
+		} else if(it->token == LEX_T_FORWARD || it->token == LEX_T_SWITCH_TABLE) {
+			// ignore Forwarder- and SwitchTable-Token
 		} else if(it->token == LEX_R_FOR) {
 			OutString.append(CScriptToken::getTokenStr(it->token));
 			skip_collon=2;
@@ -1069,9 +1421,7 @@ string CScriptToken::getParsableString(TOKEN_VECT_it Begin, TOKEN_VECT_it End, c
 
 void CScriptToken::clear()
 {
-	if(LEX_TOKEN_DATA_FLOAT(token))
-		delete floatData;
-	else if(!LEX_TOKEN_DATA_SIMPLE(token))
+	if(!LEX_TOKEN_DATA_SIMPLE(token))
 		tokenData->unref();
 	token = 0;
 }
@@ -1112,12 +1462,14 @@ const char *CScriptToken::isReservedWord(int Token) {
 	return 0;
 }
 int CScriptToken::isReservedWord(const string &Str) {
-	const char *str = Str.c_str();
+	return isReservedWord(Str.c_str(), Str.length());
+}
+int CScriptToken::isReservedWord(const char *Str, size_t Len) {
+	if(Len < 2) return LEX_ID;
 	if(!tokens2str_sorted) tokens2str_sorted=tokens2str_sort();
-	token2str_t **found = lower_bound(str2reserved_begin, str2reserved_end, str, token2str_cmp_t());
-	if(found != str2reserved_end && strcmp((*found)->str, str)==0) {
-		return (*found)->id;
-	}
+	token2str_t *found = reserved_words_hash[reservedWordHash(Str, Len)];
+	if(found && strncmp(found->str, Str, Len)==0 && found->str[Len]==0)
+		return found->id;
 	return LEX_ID;
 }
 
@@ -1126,14 +1478,28 @@ int CScriptToken::isReservedWord(const string &Str) {
 /// CScriptTokenizer
 //////////////////////////////////////////////////////////////////////////
 
+static void foldConstants(TOKEN_VECT &Tokens);
+
 CScriptTokenizer::CScriptTokenizer() : l(0), prevPos(&tokens) {
 }
 CScriptTokenizer::CScriptTokenizer(CScriptLex &Lexer) : l(0), prevPos(&tokens) {
 	tokenizeCode(Lexer);
 }
+bool CScriptTokenizer::lazyFunctions = false;
+bool CScriptTokenizer::constantFolding = true;
 CScriptTokenizer::CScriptTokenizer(const char *Code, const string &File, int Line, int Column) : l(0), prevPos(&tokens) {
 	CScriptLex lexer(Code, File, Line, Column);
-	tokenizeCode(lexer);
+	try {
+		tokenizeCode(lexer);
+	} catch (...) {
+		source = CScriptTokenDataPtr<CScriptTokenDataSource>();
+		throw;
+	}
+	source = CScriptTokenDataPtr<CScriptTokenDataSource>(); // only the functions keep the source alive
+}
+CScriptTokenizer::CScriptTokenizer(const CScript &Script) : l(0), script(const_cast<CScript&>(Script).data), prevPos(&script->tokens) {
+	pushTokenScope(script->tokens);
+	currentFile = script->file;
 }
 void CScriptTokenizer::tokenizeCode(CScriptLex &Lexer) {
 	try {
@@ -1150,6 +1516,7 @@ void CScriptTokenizer::tokenizeCode(CScriptLex &Lexer) {
 		} while (l->tk!=LEX_EOF);
 		pushToken(state.Tokens, LEX_EOF); // add LEX_EOF-Token
 		removeEmptyForwarder(state);
+		if(constantFolding) foldConstants(state.Tokens);
 //		TOKEN_VECT(tokens).swap(tokens);//	tokens.shrink_to_fit();
 		tokens.swap(state.Tokens);
 		pushTokenScope(tokens);
@@ -1229,6 +1596,29 @@ enum {
 	TOKENIZE_FLAGS_noBlockStart	= 1<<9,
 	TOKENIZE_FLAGS_nestedObject	= 1<<10,
 };
+void CScriptTokenizer::tokenizeLazyBody(CScriptTokenDataFnc &Fnc) {
+	CScriptLex lexer(Fnc.source->code, Fnc.file);
+	resetToLazyBody(lexer, Fnc);
+	l = &lexer;
+	source = Fnc.source; // for the nested functions
+	try {
+		int line = lexer.currentLine(), column = lexer.currentColumn();
+		ScriptTokenState functionState;
+		tokenizeBlock(functionState, TOKENIZE_FLAGS_canReturn | TOKENIZE_FLAGS_canYield);
+		if(functionState.HaveReturnValue == true && functionState.FunctionIsGenerator == true)
+			throw new CScriptException(TypeError, "generator function returns a value.", Fnc.file, line, column);
+		Fnc.isGenerator = functionState.FunctionIsGenerator;
+		if(constantFolding) foldConstants(functionState.Tokens);
+		functionState.Tokens.swap(Fnc.body);
+	} catch (...) {
+		l = 0;
+		source = CScriptTokenDataPtr<CScriptTokenDataSource>();
+		throw;
+	}
+	l = 0;
+	source = CScriptTokenDataPtr<CScriptTokenDataSource>();
+}
+
 void CScriptTokenizer::tokenizeTry(ScriptTokenState &State, int Flags) {
 	l->match(LEX_R_TRY);
 	CScriptToken TryToken(LEX_T_TRY);
@@ -1278,6 +1668,23 @@ void CScriptTokenizer::tokenizeTry(ScriptTokenState &State, int Flags) {
 	}
 	State.Tokens.swap(mainTokens);
 }
+// adds a case label to the jump table of a switch - false if the label isn't a number- or string-literal
+static bool addSwitchCase(CScriptTokenDataSwitchTable &Table, TOKEN_VECT &Tokens, size_t LabelBegin, int Colon) {
+	bool negative = Tokens.size()-LabelBegin == 2 && Tokens[LabelBegin].token == '-';
+	if(negative) ++LabelBegin;
+	if(Tokens.size()-LabelBegin != 1) return false;
+	CScriptToken &label = Tokens[LabelBegin];
+	// insert keeps the first of equal labels - as the sequential compare
+	if(label.token == LEX_STR && !negative)
+		Table.stringCases.insert(make_pair(label.String(), Colon));
+	else if(label.token == LEX_INT)
+		Table.numberCases.insert(make_pair(negative ? -double(label.Number().intData) : double(label.Number().intData), Colon));
+	else if(label.token == LEX_FLOAT)
+		Table.numberCases.insert(make_pair(negative ? -label.Float() : label.Float(), Colon));
+	else
+		return false;
+	return true;
+}
 void CScriptTokenizer::tokenizeSwitch(ScriptTokenState &State, int Flags) {
 
 	State.Marks.push_back(pushToken(State.Tokens)); // push Token & push tokenBeginIdx
@@ -1288,6 +1695,11 @@ void CScriptTokenizer::tokenizeSwitch(ScriptTokenState &State, int Flags) {
 	State.Marks.push_back(pushToken(State.Tokens, '{')); // push Token & push blockBeginIdx
 	pushForwarder(State);
 	
+	// the jump table holds the indices of the ':' until the switch is complete
+	CScriptToken switchTable(LEX_T_SWITCH_TABLE);
+	CScriptTokenDataSwitchTable &Table = switchTable.SwitchTable();
+	bool constantCases = true;
+	Table.defaultCase = -1;
 
 	vector<int>::size_type MarksSize = State.Marks.size();
 	Flags |= TOKENIZE_FLAGS_canBreak;
@@ -1296,12 +1708,15 @@ void CScriptTokenizer::tokenizeSwitch(ScriptTokenState &State, int Flags) {
 			if(l->tk == LEX_R_CASE) {
 				State.Marks.push_back(pushToken(State.Tokens)); // push Token & push caseBeginIdx
 				State.Marks.push_back(pushToken(State.Tokens,CScriptToken(LEX_T_SKIP))); //  skipper to skip case-expression
+				size_t labelBegin = State.Tokens.size();
 				tokenizeExpression(State, Flags); 
 				setTokenSkip(State);
+				if(constantCases) constantCases = addSwitchCase(Table, State.Tokens, labelBegin, State.Tokens.size());
 			} else { // default
 				State.Marks.push_back(pushToken(State.Tokens)); // push Token & push caseBeginIdx
 				if(hasDefault) throw new CScriptException(SyntaxError, "more than one switch default", l->currentFile, l->currentLine(), l->currentColumn());
 				hasDefault = true;
+				Table.defaultCase = State.Tokens.size();
 			}
 
 			State.Marks.push_back(pushToken(State.Tokens, ':'));
@@ -1314,7 +1729,18 @@ void CScriptTokenizer::tokenizeSwitch(ScriptTokenState &State, int Flags) {
 			throw new CScriptException(SyntaxError, "invalid switch statement", l->currentFile, l->currentLine(), l->currentColumn());
 	}
 	while(MarksSize < State.Marks.size()) setTokenSkip(State);
+	int tokensSize = State.Tokens.size();
 	removeEmptyForwarder(State); // remove Forwarder if empty
+	if(constantCases && (Table.numberCases.size() || Table.stringCases.size())) {
+		// insert the table behind '{' and the forwarder and convert the indices to offsets
+		int removed = tokensSize - State.Tokens.size(), tableIdx = State.Marks.back() + 2 - removed;
+		int toOffset = 1 - removed - tableIdx;
+		if(Table.defaultCase < 0) Table.defaultCase = tokensSize; // no default -> to the '}'
+		Table.defaultCase += toOffset;
+		for(CScriptTokenDataSwitchTable::NUMBER_CASES_t::iterator it=Table.numberCases.begin(); it!=Table.numberCases.end(); ++it) it->second += toOffset;
+		for(CScriptTokenDataSwitchTable::STRING_CASES_t::iterator it=Table.stringCases.begin(); it!=Table.stringCases.end(); ++it) it->second += toOffset;
+		State.Tokens.insert(State.Tokens.begin()+tableIdx, switchTable);
+	}
 	pushToken(State.Tokens, '}');
 	setTokenSkip(State); // switch-block
 	setTokenSkip(State); // switch-statement
@@ -1478,12 +1904,9 @@ void CScriptTokenizer::tokenizeFor(ScriptTokenState &State, int Flags) {
 	State.Tokens.swap(LoopData.body);
 	State.Tokens.swap(mainTokens);
 	if(for_in) {
+		// the loop assigns the next value of the iterator to LEX_T_EXCEPTION_VAR
 		LoopData.condition.push_back('=');
 		LoopData.condition.push_back(LEX_T_EXCEPTION_VAR);
-		LoopData.condition.push_back('.');
-		LoopData.condition.push_back(CScriptToken(LEX_ID, "next"));
-		LoopData.condition.push_back('(');
-		LoopData.condition.push_back(')');
 		LoopData.condition.push_back(';');
 	}
 	PopLoopLabels(label_count, State.LoopLabels);
@@ -1557,7 +1980,7 @@ CScriptToken CScriptTokenizer::tokenizeFunctionArgument() {
 	return tokenizeVarIdentifier(0, &withAssignment);
 }
 
-void CScriptTokenizer::tokenizeArrowFunction(const TOKEN_VECT &Arguments, ScriptTokenState &State, int Flags, bool noLetDef/*=false*/)
+void CScriptTokenizer::tokenizeArrowFunction(const TOKEN_VECT &Arguments, const char *Begin, ScriptTokenState &State, int Flags, bool noLetDef/*=false*/)
 {
 	l->match(LEX_ARROW);
 	CScriptToken FncToken(LEX_T_FUNCTION_OPERATOR);
@@ -1576,6 +1999,12 @@ void CScriptTokenizer::tokenizeArrowFunction(const TOKEN_VECT &Arguments, Script
 		functionState.HaveReturnValue = true;
 	}
 	functionState.Tokens.swap(FncData.body);
+	// the text from the arguments to the end of the body - like the other functions (the tokens may be folded)
+	const char *code = l->getCode();
+	if(!source) source = CScriptTokenDataPtr<CScriptTokenDataSource>(*new CScriptTokenDataSource(code));
+	FncData.source = source;
+	FncData.sourceBegin = Begin - code;
+	FncData.sourceEnd = l->tokenEnd - code;
 	State.Tokens.push_back(FncToken);
 }
 
@@ -1616,19 +2045,38 @@ void CScriptTokenizer::tokenizeFunction(ScriptTokenState &State, int Flags, bool
 	FncData.file = l->currentFile;
 	FncData.line = l->currentLine();
 
-	ScriptTokenState functionState;
-	if(l->tk == '{' || tk==LEX_T_GET || tk==LEX_T_SET)
-		tokenizeBlock(functionState, TOKENIZE_FLAGS_canReturn | TOKENIZE_FLAGS_canYield);
-	else {
-		tokenizeExpression(functionState, TOKENIZE_FLAGS_canYield);
-		if(Statement) l->match(';');
-		functionState.HaveReturnValue = true;
-	}
-	if(functionState.HaveReturnValue == true && functionState.FunctionIsGenerator == true)
-		throw new CScriptException(TypeError, "generator function returns a value.", l->currentFile, functionPos.currentLine, functionPos.currentColumn());
-	FncData.isGenerator = functionState.FunctionIsGenerator;
+	const char *code = l->getCode(), *end = 0;
+	if(!source) // the copy of the source is shared by all functions of the code (a CScript of a CScriptSource presets the source)
+		source = CScriptTokenDataPtr<CScriptTokenDataSource>(*new CScriptTokenDataSource(code));
+	FncData.source = source;
+	if(lazyFunctions && l->tk == '{') { // pre-parse - the body is tokenized on the first call
+		CScriptTokenDataFnc::LAZY_BODY *Lazy = new CScriptTokenDataFnc::LAZY_BODY;
+		Lazy->begin = l->pos.tokenStart - code;
+		Lazy->lineStart = l->pos.currentLineStart - code;
+		Lazy->line = l->pos.currentLine;
+		Lazy->shared = false;
+		FncData.lazy = Lazy;
+		scanFunctionBody(*l);
+	} else {
+		ScriptTokenState functionState;
+		if(l->tk == '{' || tk==LEX_T_GET || tk==LEX_T_SET)
+			tokenizeBlock(functionState, TOKENIZE_FLAGS_canReturn | TOKENIZE_FLAGS_canYield);
+		else {
+			tokenizeExpression(functionState, TOKENIZE_FLAGS_canYield);
+			end = l->tokenEnd;
+			if(Statement) l->match(';');
+			functionState.HaveReturnValue = true;
+		}
+		if(functionState.HaveReturnValue == true && functionState.FunctionIsGenerator == true)
+			throw new CScriptException(TypeError, "generator function returns a value.", l->currentFile, functionPos.currentLine, functionPos.currentColumn());
+		FncData.isGenerator = functionState.FunctionIsGenerator;
 
-	functionState.Tokens.swap(FncData.body);
+		functionState.Tokens.swap(FncData.body);
+	}
+	if(!Accessor) {
+		FncData.sourceBegin = functionPos.tokenStart - code;
+		FncData.sourceEnd = (end ? end : l->tokenEnd) - code;
+	}
 	if(forward) {
 		State.Forwarders.front()->functions.insert(FncToken);
 		FncToken.token = LEX_T_FUNCTION_PLACEHOLDER;
@@ -1915,6 +2363,7 @@ void CScriptTokenizer::tokenizeLiteral(ScriptTokenState &State, int Flags) {
 	case LEX_ID:
 		{
 			string label = l->tkStr;
+			const char *labelBegin = l->pos.tokenStart;
 			l->match(LEX_ID);
 			if(label != "this" && l->tk == LEX_ARROW) { // Arrow-Function
 				TOKEN_VECT arguments; 
@@ -1923,7 +2372,7 @@ void CScriptTokenizer::tokenizeLiteral(ScriptTokenState &State, int Flags) {
 				token.column = l->currentColumn();
 				token.line = l->currentLine();
 				arguments.push_back(token);
-				tokenizeArrowFunction(arguments, State, Flags);
+				tokenizeArrowFunction(arguments, labelBegin, State, Flags);
 			} else {
 				pushToken(State.Tokens, CScriptToken(LEX_ID, label));
 				if(l->tk==':' && canLabel) {
@@ -1952,20 +2401,23 @@ void CScriptTokenizer::tokenizeLiteral(ScriptTokenState &State, int Flags) {
 		break;
 	case '{':
 	case '[':
-		if(l->tk == '{')
-			_tokenizeLiteralObject(State, ObjectLiteralFlags);
-		else
-			_tokenizeLiteralArray(State, ObjectLiteralFlags);
-		if(State.LeftHand && l->tk==LEX_ARROW) {
-			TOKEN_VECT arguments; 
-			CScriptToken token(LEX_T_DESTRUCTURING_VAR);
-			State.Tokens.back().Object().toDestructuringVar(token.DestructuringVar());
+		{
+			const char *literalBegin = l->pos.tokenStart;
+			if(l->tk == '{')
+				_tokenizeLiteralObject(State, ObjectLiteralFlags);
+			else
+				_tokenizeLiteralArray(State, ObjectLiteralFlags);
+			if(State.LeftHand && l->tk==LEX_ARROW) {
+				TOKEN_VECT arguments; 
+				CScriptToken token(LEX_T_DESTRUCTURING_VAR);
+				State.Tokens.back().Object().toDestructuringVar(token.DestructuringVar());
 //			token.DestructuringVar().vars.push_back(DESTRUCTURING_VAR_t("", label));
 
-			arguments.push_back(token);
-			State.Tokens.pop_back();
-			tokenizeArrowFunction(arguments, State, Flags);
-			State.LeftHand = false;
+				arguments.push_back(token);
+				State.Tokens.pop_back();
+				tokenizeArrowFunction(arguments, literalBegin, State, Flags);
+				State.LeftHand = false;
+			}
 		}
 		break;
 	case LEX_R_LET: // let as expression
@@ -1995,6 +2447,7 @@ void CScriptTokenizer::tokenizeLiteral(ScriptTokenState &State, int Flags) {
 #endif
 	case '(':
 		{
+			const char *argumentsBegin = l->pos.tokenStart;
 			l->match('(');
 			CScriptLex::POS prev_pos = l->pos;
 			if(l->tk==LEX_ID || l->tk=='[' || l->tk=='{') {
@@ -2008,7 +2461,7 @@ void CScriptTokenizer::tokenizeLiteral(ScriptTokenState &State, int Flags) {
 					}
 					if((arguments_ok = arguments_ok && l->tk == ')')) l->match(')');
 					if(arguments_ok && l->tk == LEX_ARROW) {
-						tokenizeArrowFunction(arguments, State, Flags);
+						tokenizeArrowFunction(arguments, argumentsBegin, State, Flags);
 						break;
 					}
 				} catch(...) { /* ignore Error -> try regular (...)-expression */ }
@@ -2318,6 +2771,888 @@ void CScriptTokenizer::throwTokenNotExpected() {
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+/// CConstantFolder
+//////////////////////////////////////////////////////////////////////////
+
+// Operators with constant operands (number and string literals, true, false, null) are evaluated
+// once after tokenizing and replaced by a literal, an if-statement or a ?: with a constant condition
+// by the taken branch. The evaluation follows CTinyJS::mathsOp and execute_unary - so folded and
+// unfolded code give the same values (run_tests -f compares both).
+//
+// The tokens are flat (in source order) - the folder parses the operands of an operator like the
+// execute_xxx functions. An operand is folded only up to the precedence allowed by the token in
+// front of it (e.g. in "a - 2 + 3" only "2"). Removed tokens are taken out of the skip-offsets.
+
+class CConstantFolder {
+public:
+	CConstantFolder(TOKEN_VECT &Tokens) : tokens(Tokens) {}
+	bool fold(); ///< one pass over tokens - returns false if nothing was folded
+private:
+	enum LEVELS { // like the execute_xxx functions
+		LEVEL_UNARY,
+		LEVEL_TERM,
+		LEVEL_EXPRESSION,
+		LEVEL_SHIFT,
+		LEVEL_RELATION,
+		LEVEL_EQUALITY,
+		LEVEL_BINARY_AND,
+		LEVEL_BINARY_XOR,
+		LEVEL_BINARY_OR,
+		LEVEL_LOGIC_AND,
+		LEVEL_LOGIC_OR,
+		LEVEL_CONDITION,
+	};
+	struct VALUE {
+		enum { NUMBER, STRING, BOOLEAN, NULL_VALUE } type;
+		CNumber number;
+		string str;
+		bool boolean;
+		CNumber toNumber() const;
+		string toString() const;
+		bool toBoolean() const;
+		const char *getVarType() const;
+	};
+	struct REPLACEMENT {
+		size_t begin, end;
+		TOKEN_VECT tokens;
+	};
+	static int binaryLevel(int Token);
+	int levelBehind(size_t Pos);
+	bool parse(size_t &Pos, int Level, VALUE &Value, bool &Truncated);
+	bool parsePrimary(size_t &Pos, VALUE &Value);
+	static void mathsOp(VALUE &A, const VALUE &B, int op);
+	static CScriptToken valueToken(const VALUE &Value, const CScriptToken &Pos);
+	bool foldIf(size_t Pos, REPLACEMENT &Replacement);
+	void replace(vector<REPLACEMENT> &Replacements);
+	TOKEN_VECT &tokens;
+};
+
+CNumber CConstantFolder::VALUE::toNumber() const {
+	switch(type) {
+	case NUMBER: return number;
+	case STRING: return str.c_str();
+	case BOOLEAN: return boolean?1:0;
+	default: return 0;
+	}
+}
+string CConstantFolder::VALUE::toString() const {
+	switch(type) {
+	case NUMBER: return number.toString();
+	case STRING: return str;
+	case BOOLEAN: return boolean ? "true" : "false";
+	default: return "null";
+	}
+}
+bool CConstantFolder::VALUE::toBoolean() const {
+	switch(type) {
+	case NUMBER: return number.toBoolean();
+	case STRING: return str.length()!=0;
+	case BOOLEAN: return boolean;
+	default: return false;
+	}
+}
+const char *CConstantFolder::VALUE::getVarType() const {
+	static const char *types[] = { "number", "string", "boolean", "null" };
+	return types[type];
+}
+
+int CConstantFolder::binaryLevel(int Token) {
+	switch(Token) {
+	case '*': case '/': case '%': return LEVEL_TERM;
+	case '+': case '-': return LEVEL_EXPRESSION;
+	case LEX_LSHIFT: case LEX_RSHIFT: case LEX_RSHIFTU: return LEVEL_SHIFT;
+	case '<': case LEX_LEQUAL: case '>': case LEX_GEQUAL: case LEX_R_IN: case LEX_R_INSTANCEOF: return LEVEL_RELATION;
+	case LEX_EQUAL: case LEX_NEQUAL: case LEX_TYPEEQUAL: case LEX_NTYPEEQUAL: return LEVEL_EQUALITY;
+	case '&': return LEVEL_BINARY_AND;
+	case '^': return LEVEL_BINARY_XOR;
+	case '|': return LEVEL_BINARY_OR;
+	case LEX_ANDAND: return LEVEL_LOGIC_AND;
+	case LEX_OROR: return LEVEL_LOGIC_OR;
+	}
+	return -1;
+}
+
+// the highest level of an operand starting at Pos (-1 = not foldable)
+int CConstantFolder::levelBehind(size_t Pos) {
+	if(Pos == 0) return LEVEL_CONDITION;
+	int tk = tokens[Pos-1].token;
+	switch(tk) {
+	case ';': case '{': case '}': case '(': case '[': case ',': case '=': case '?': case ':':
+	case LEX_T_SKIP: case LEX_R_RETURN: case LEX_R_THROW: case LEX_R_CASE: case LEX_R_ELSE:
+		return LEVEL_CONDITION;
+	case '+': case '-': // unary or binary
+		if(Pos < 2) return -1;
+		switch(tokens[Pos-2].token) {
+		case LEX_ID: case LEX_STR: case LEX_INT: case LEX_FLOAT: case LEX_REGEXP: case LEX_R_TRUE: case LEX_R_FALSE: case LEX_R_NULL:
+		case ')': case ']': case LEX_T_OBJECT_LITERAL: case LEX_T_FUNCTION_OPERATOR:
+			return LEVEL_EXPRESSION-1;
+		}
+		return -1;
+	}
+	if(tk >= LEX_ASSIGNMENTS_BEGIN && tk <= LEX_ASSIGNMENTS_END) return LEVEL_CONDITION;
+	int level = binaryLevel(tk);
+	return level > LEVEL_UNARY ? level-1 : -1;
+}
+
+// parses a constant expression of Level at Pos - Pos is moved behind it
+// Truncated: the expression continues with a non-constant operand -> only the tokens up to Pos are constant
+bool CConstantFolder::parse(size_t &Pos, int Level, VALUE &Value, bool &Truncated) {
+	Truncated = false;
+	if(Pos >= tokens.size()) return false;
+	if(Level == LEVEL_UNARY) {
+		int op = tokens[Pos].token;
+		if(op != '-' && op != '+' && op != '!' && op != '~' && op != LEX_R_TYPEOF)
+			return parsePrimary(Pos, Value);
+		size_t pos = Pos+1;
+		if(!parse(pos, LEVEL_UNARY, Value, Truncated)) return false;
+		switch(op) {
+		case '-': Value.number = -Value.toNumber(); Value.type = VALUE::NUMBER; break;
+		case '+': Value.number = Value.toNumber(); Value.type = VALUE::NUMBER; break;
+		case '~': Value.number = ~Value.toNumber(); Value.type = VALUE::NUMBER; break;
+		case '!': Value.boolean = !Value.toBoolean(); Value.type = VALUE::BOOLEAN; break;
+		default: Value.str = Value.getVarType(); Value.type = VALUE::STRING;
+		}
+		Pos = pos;
+		return true;
+	}
+	if(Level == LEVEL_CONDITION) { // L<-R
+		if(!parse(Pos, LEVEL_LOGIC_OR, Value, Truncated)) return false;
+		if(Truncated || Pos >= tokens.size() || tokens[Pos].token != '?') return true;
+		size_t pos = Pos+1;
+		VALUE a, b;
+		bool truncated;
+		if(parse(pos, LEVEL_CONDITION, a, truncated) && !truncated && pos < tokens.size() && tokens[pos].token == ':'
+				&& parse(++pos, LEVEL_CONDITION, b, truncated) && !truncated) {
+			Value = Value.toBoolean() ? a : b;
+			Pos = pos;
+		} else
+			Truncated = true;
+		return true;
+	}
+	// L->R
+	if(!parse(Pos, Level-1, Value, Truncated)) return false;
+	while(!Truncated && Pos < tokens.size() && binaryLevel(tokens[Pos].token) == Level) {
+		int op = tokens[Pos].token;
+		size_t pos = Pos+1;
+		VALUE b;
+		bool truncated;
+		if(op == LEX_R_IN || op == LEX_R_INSTANCEOF || !parse(pos, Level-1, b, truncated) || truncated) {
+			Truncated = true;
+			break;
+		}
+		if(op == LEX_ANDAND || op == LEX_OROR) {
+			if(Value.toBoolean() == (op == LEX_ANDAND)) Value = b;
+		} else
+			mathsOp(Value, b, op);
+		Pos = pos;
+	}
+	return true;
+}
+
+bool CConstantFolder::parsePrimary(size_t &Pos, VALUE &Value) {
+	size_t pos = Pos;
+	CScriptToken &tk = tokens[pos];
+	switch(tk.token) {
+	case LEX_INT: Value.type = VALUE::NUMBER; Value.number = tk.Number().intData; break;
+	case LEX_FLOAT: Value.type = VALUE::NUMBER; Value.number = tk.Float(); break;
+	case LEX_STR: Value.type = VALUE::STRING; Value.str = tk.String(); break;
+	case LEX_R_TRUE:
+	case LEX_R_FALSE: Value.type = VALUE::BOOLEAN; Value.boolean = tk.token == LEX_R_TRUE; break;
+	case LEX_R_NULL: Value.type = VALUE::NULL_VALUE; break;
+	case '(':
+		{
+			bool truncated;
+			if(!parse(++pos, LEVEL_CONDITION, Value, truncated) || truncated || pos >= tokens.size() || tokens[pos].token != ')') return false;
+		}
+		break;
+	default:
+		return false;
+	}
+	if(++pos < tokens.size()) {
+		switch(tokens[pos].token) { // the value is used as an object or a left-hand side
+		case '.': case '[': case '(': case LEX_PLUSPLUS: case LEX_MINUSMINUS:
+			return false;
+		}
+	}
+	Pos = pos;
+	return true;
+}
+
+// see CTinyJS::mathsOp
+void CConstantFolder::mathsOp(VALUE &A, const VALUE &B, int op) {
+	if (op == LEX_TYPEEQUAL || op == LEX_NTYPEEQUAL) {
+		if( (A.type == B.type) ^ (op == LEX_TYPEEQUAL)) {
+			A.type = VALUE::BOOLEAN; A.boolean = false;
+			return;
+		}
+		op = op == LEX_TYPEEQUAL ? LEX_EQUAL : LEX_NEQUAL;
+	}
+	int result = -1; // boolean result
+	bool a_isString = A.type == VALUE::STRING;
+	bool b_isString = B.type == VALUE::STRING;
+	if( (a_isString && b_isString) || ((a_isString || b_isString) && op == '+')) {
+		string da = A.type == VALUE::NULL_VALUE ? "" : A.toString();
+		string db = B.type == VALUE::NULL_VALUE ? "" : B.toString();
+		switch (op) {
+		case '+': A.str = da+db; A.type = VALUE::STRING; return;
+		case LEX_EQUAL:	result = da==db; break;
+		case LEX_NEQUAL:	result = da!=db; break;
+		case '<':			result = da<db; break;
+		case LEX_LEQUAL:	result = da<=db; break;
+		case '>':			result = da>db; break;
+		case LEX_GEQUAL:	result = da>=db; break;
+		}
+	} else if(A.type == VALUE::NULL_VALUE && B.type == VALUE::NULL_VALUE) {
+		switch (op) {
+		case LEX_EQUAL:	result = true; break;
+		case LEX_NEQUAL:
+		case LEX_GEQUAL:
+		case LEX_LEQUAL:
+		case '<':
+		case '>':			result = false; break;
+		}
+	}
+	if(result < 0) {
+		CNumber da = A.toNumber();
+		CNumber db = B.toNumber();
+		A.type = VALUE::NUMBER;
+		switch (op) {
+		case '+':			A.number = da+db; return;
+		case '-':			A.number = da-db; return;
+		case '*':			A.number = da*db; return;
+		case '/':			A.number = da/db; return;
+		case '%':			A.number = da%db; return;
+		case '&':			A.number = da.toInt32()&db.toInt32(); return;
+		case '|':			A.number = da.toInt32()|db.toInt32(); return;
+		case '^':			A.number = da.toInt32()^db.toInt32(); return;
+		case LEX_LSHIFT:	A.number = da<<db; return;
+		case LEX_RSHIFT:	A.number = da>>db; return;
+		case LEX_RSHIFTU:	A.number = da.ushift(db); return;
+		case LEX_EQUAL:	result = da==db; break;
+		case LEX_NEQUAL:	result = da!=db; break;
+		case '<':			result = da<db; break;
+		case LEX_LEQUAL:	result = da<=db; break;
+		case '>':			result = da>db; break;
+		case LEX_GEQUAL:	result = da>=db; break;
+		}
+	}
+	A.type = VALUE::BOOLEAN;
+	A.boolean = result != 0;
+}
+
+CScriptToken CConstantFolder::valueToken(const VALUE &Value, const CScriptToken &Pos) {
+	CScriptToken Token;
+	switch(Value.type) {
+	case VALUE::NUMBER:
+		if(Value.number.isInt32())
+			Token = CScriptToken(LEX_INT, Value.number.toInt32());
+		else {
+			Token.token = LEX_FLOAT;
+			(Token.tokenData = new CScriptTokenDataNumber(Value.number.toDouble()))->ref();
+		}
+		break;
+	case VALUE::STRING: Token = CScriptToken(LEX_STR, Value.str); break;
+	case VALUE::BOOLEAN: Token = CScriptToken(Value.boolean ? LEX_R_TRUE : LEX_R_FALSE); break;
+	default: Token = CScriptToken(LEX_R_NULL);
+	}
+	Token.line = Pos.line;
+	Token.column = Pos.column;
+	return Token;
+}
+
+// if(constant) statement [else statement] -> the taken statement (see tokenizeIf)
+bool CConstantFolder::foldIf(size_t Pos, REPLACEMENT &Replacement) {
+	size_t skip = Pos+4;
+	if(skip >= tokens.size() || tokens[Pos+1].token != '(' || tokens[Pos+3].token != ')' || tokens[skip].token != LEX_T_SKIP) return false;
+	VALUE cond;
+	size_t pos = Pos+2;
+	if(!parsePrimary(pos, cond)) return false;
+	size_t end = Pos + tokens[Pos].Int(), thenEnd = skip + tokens[skip].Int();
+	Replacement.begin = Pos;
+	Replacement.end = end;
+	if(cond.toBoolean())
+		Replacement.tokens.assign(tokens.begin()+skip+1, tokens.begin()+thenEnd);
+	else if(thenEnd < end && tokens[thenEnd].token == LEX_R_ELSE)
+		Replacement.tokens.assign(tokens.begin()+thenEnd+1, tokens.begin()+end);
+	else
+		Replacement.tokens.assign(1, CScriptToken(';'));
+	return true;
+}
+
+bool CConstantFolder::fold() {
+	vector<REPLACEMENT> replacements;
+	for(size_t i=0; i<tokens.size(); ) {
+		REPLACEMENT replacement;
+		if(tokens[i].token == LEX_R_IF && foldIf(i, replacement)) {
+			i = replacement.end;
+			replacements.push_back(replacement);
+			continue;
+		}
+		int level = levelBehind(i);
+		size_t pos = i;
+		VALUE value;
+		bool truncated;
+		if(level >= 0 && parse(pos, level, value, truncated) && pos-i > 1) {
+			replacement.begin = i;
+			replacement.end = pos;
+			replacement.tokens.assign(1, valueToken(value, tokens[i]));
+			replacements.push_back(replacement);
+			i = pos;
+		} else
+			i++;
+	}
+	if(replacements.empty()) return false;
+	replace(replacements);
+	return true;
+}
+
+// replaces the token ranges and corrects the skip-offsets over them
+void CConstantFolder::replace(vector<REPLACEMENT> &Replacements) {
+	TOKEN_VECT folded;
+	folded.reserve(tokens.size());
+	vector<size_t> newPos(tokens.size()+1);
+	vector<REPLACEMENT>::iterator r = Replacements.begin();
+	for(size_t i=0; i<tokens.size(); ) {
+		if(r != Replacements.end() && r->begin == i) {
+			for(; i<r->end; i++) newPos[i] = folded.size();
+			folded.insert(folded.end(), r->tokens.begin(), r->tokens.end());
+			++r;
+		} else {
+			newPos[i] = folded.size();
+			folded.push_back(tokens[i++]);
+		}
+	}
+	newPos[tokens.size()] = folded.size();
+	r = Replacements.begin();
+	for(size_t i=0; i<tokens.size(); i++) {
+		if(r != Replacements.end() && r->begin == i) { // the skip-offsets in the replacement are unchanged
+			i = (r++)->end - 1;
+			continue;
+		}
+		if(LEX_TOKEN_DATA_SIMPLE(tokens[i].token) && tokens[i].Int() > 0) {
+			size_t skipTo = i + tokens[i].Int();
+			ASSERT(skipTo == tokens.size() || newPos[skipTo] != newPos[skipTo-1]); // not into a replaced range
+			folded[newPos[i]].Int() = (int)(newPos[skipTo] - newPos[i]);
+		} else if(LEX_TOKEN_DATA_SWITCH_TABLE(tokens[i].token)) {
+			CScriptTokenDataSwitchTable &Table = folded[newPos[i]].SwitchTable();
+			Table.defaultCase = (int)(newPos[i+Table.defaultCase] - newPos[i]);
+			for(CScriptTokenDataSwitchTable::NUMBER_CASES_t::iterator it=Table.numberCases.begin(); it!=Table.numberCases.end(); ++it)
+				it->second = (int)(newPos[i+it->second] - newPos[i]);
+			for(CScriptTokenDataSwitchTable::STRING_CASES_t::iterator it=Table.stringCases.begin(); it!=Table.stringCases.end(); ++it)
+				it->second = (int)(newPos[i+it->second] - newPos[i]);
+		}
+	}
+	tokens.swap(folded);
+}
+
+static void foldConstants(CScriptTokenDataFnc &Fnc) {
+	foldConstants(Fnc.arguments);
+	if(!Fnc.isLazy()) foldConstants(Fnc.body); // a lazy body is folded when it is tokenized
+}
+static void foldConstants(TOKEN_VECT &Tokens) {
+	for(CConstantFolder folder(Tokens); folder.fold(); ) {} // a taken branch may contain foldable if-statements
+	for(TOKEN_VECT_it it=Tokens.begin(); it!=Tokens.end(); ++it) {
+		int tk = it->token;
+		if(LEX_TOKEN_DATA_FUNCTION(tk)) {
+			if(tk != LEX_T_FUNCTION_PLACEHOLDER) foldConstants(it->Fnc()); // the function is in the forwarder
+		} else if(LEX_TOKEN_DATA_LOOP(tk)) {
+			CScriptTokenDataLoop &Loop = it->Loop();
+			foldConstants(Loop.init);
+			foldConstants(Loop.condition);
+			foldConstants(Loop.iter);
+			foldConstants(Loop.body);
+		} else if(LEX_TOKEN_DATA_TRY(tk)) {
+			CScriptTokenDataTry &Try = it->Try();
+			foldConstants(Try.tryBlock);
+			for(CScriptTokenDataTry::CatchBlock_it catchBlock=Try.catchBlocks.begin(); catchBlock!=Try.catchBlocks.end(); ++catchBlock) {
+				if(catchBlock->indentifiers) foldConstants(catchBlock->indentifiers->assignment);
+				foldConstants(catchBlock->condition);
+				foldConstants(catchBlock->block);
+			}
+			foldConstants(Try.finallyBlock);
+		} else if(LEX_TOKEN_DATA_OBJECT_LITERAL(tk)) {
+			CScriptTokenDataObjectLiteral &Objc = it->Object();
+			for(vector<CScriptTokenDataObjectLiteral::ELEMENT>::iterator element=Objc.elements.begin(); element!=Objc.elements.end(); ++element)
+				foldConstants(element->value);
+		} else if(LEX_TOKEN_DATA_DESTRUCTURING_VAR(tk)) {
+			foldConstants(it->DestructuringVar().assignment);
+		} else if(LEX_TOKEN_DATA_FORWARDER(tk)) {
+			CScriptTokenDataForwards &Forwarder = it->Forwarder();
+			for(CScriptTokenDataForwards::FNC_SET_it fnc=Forwarder.functions.begin(); fnc!=Forwarder.functions.end(); ++fnc)
+				foldConstants(const_cast<CScriptToken&>(*fnc).Fnc());
+		}
+	}
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScript
+//////////////////////////////////////////////////////////////////////////
+
+// does all the analyses that are otherwise done lazily on first execution
+// -> the executions of a CScript never change its tokens
+static void prepareSharedFunction(CScriptTokenDataFnc &Fnc);
+static void prepareSharedTokens(TOKEN_VECT &Tokens) {
+	if(Tokens.capacity() > Tokens.size()) TOKEN_VECT(Tokens).swap(Tokens); // a compiled script lives long -> drop the spare capacity
+	for(TOKEN_VECT_it it=Tokens.begin(); it!=Tokens.end(); ++it) {
+		int tk = it->token;
+		if(LEX_TOKEN_DATA_FUNCTION(tk)) {
+			prepareSharedFunction(it->Fnc());
+		} else if(LEX_TOKEN_DATA_LOOP(tk)) {
+			CScriptTokenDataLoop &Loop = it->Loop();
+			prepareSharedTokens(Loop.init);
+			prepareSharedTokens(Loop.condition);
+			prepareSharedTokens(Loop.iter);
+			prepareSharedTokens(Loop.body);
+		} else if(LEX_TOKEN_DATA_TRY(tk)) {
+			CScriptTokenDataTry &Try = it->Try();
+			prepareSharedTokens(Try.tryBlock);
+			for(CScriptTokenDataTry::CatchBlock_it catchBlock=Try.catchBlocks.begin(); catchBlock!=Try.catchBlocks.end(); ++catchBlock) {
+				if(catchBlock->indentifiers) prepareSharedTokens(catchBlock->indentifiers->assignment);
+				prepareSharedTokens(catchBlock->condition);
+				prepareSharedTokens(catchBlock->block);
+			}
+			prepareSharedTokens(Try.finallyBlock);
+		} else if(LEX_TOKEN_DATA_OBJECT_LITERAL(tk)) {
+			CScriptTokenDataObjectLiteral &Objc = it->Object();
+			if(!Objc.destructuring && Objc.boilerplateState == CScriptTokenDataObjectLiteral::BOILERPLATE_NONE)
+				Objc.buildBoilerplate();
+			for(vector<CScriptTokenDataObjectLiteral::ELEMENT>::iterator element=Objc.elements.begin(); element!=Objc.elements.end(); ++element)
+				prepareSharedTokens(element->value);
+		} else if(LEX_TOKEN_DATA_DESTRUCTURING_VAR(tk)) {
+			prepareSharedTokens(it->DestructuringVar().assignment);
+		} else if(LEX_TOKEN_DATA_FORWARDER(tk)) {
+			CScriptTokenDataForwards &Forwarder = it->Forwarder();
+			if(!Forwarder.scopeTemplateReady) Forwarder.buildScopeTemplate();
+			for(CScriptTokenDataForwards::FNC_SET_it fnc=Forwarder.functions.begin(); fnc!=Forwarder.functions.end(); ++fnc)
+				prepareSharedFunction(const_cast<CScriptToken&>(*fnc).Fnc());
+		}
+	}
+}
+static void prepareSharedFunction(CScriptTokenDataFnc &Fnc) {
+	if(Fnc.capture == CScriptTokenDataFnc::CAPTURE_UNKNOWN) Fnc.analyzeCapture(); // before the nested functions
+	prepareSharedTokens(Fnc.arguments);
+	if(Fnc.isLazy()) {
+		Fnc.getLazyBody()->shared = true; // prepared when the body is tokenized
+		return;
+	}
+	Fnc.hasSimpleParameters();
+	prepareSharedTokens(Fnc.body);
+}
+
+// a mapped file is only read by the compiler - the functions copy the text, so a later change of the file can't affect them
+static CScriptTokenDataPtr<CScriptTokenDataSource> sourceOfFunctions(const CScriptTokenDataPtr<CScriptTokenDataSource> &Source) {
+	return Source->isMapped() ? CScriptTokenDataPtr<CScriptTokenDataSource>() : Source;
+}
+CScript::CScript(const char *Code, const string &File, int Line, int Column) {
+	compile(Code, File, Line, Column);
+}
+CScript::CScript(const string &Code, const string &File, int Line, int Column) {
+	compile(Code.c_str(), File, Line, Column);
+}
+CScript::CScript(CScriptSource *Source, const string &File, int Line, int Column) {
+	CScriptTokenDataPtr<CScriptTokenDataSource> source(*new CScriptTokenDataSource(Source));
+	compile(source->code, source->size, sourceOfFunctions(source), File, Line, Column);
+}
+void CScript::compile(const char *Code, const string &File, int Line, int Column) {
+	compile(Code, strlen(Code), CScriptTokenDataPtr<CScriptTokenDataSource>(), File, Line, Column);
+}
+void CScript::compile(const char *Code, size_t Size, const CScriptTokenDataPtr<CScriptTokenDataSource> &Source, const string &File, int Line, int Column) {
+	CScriptTokenizer Tokenizer;
+	Tokenizer.source = Source; // the functions reference the source - without a source the first function copies the code
+	CScriptLex lexer(Code, File, Line, Column);
+	Tokenizer.tokenizeCode(lexer);
+	CScriptTokenDataScript *Script = new CScriptTokenDataScript;
+	data = CScriptTokenDataPtr<CScriptTokenDataScript>(*Script);
+	Script->tokens.swap(Tokenizer.tokens);
+	Script->file = Tokenizer.currentFile;
+	Script->sourceHash = hashSource(Code, Size);
+	Script->sourceSize = (uint32_t)Size;
+	Script->line = Line;
+	Script->column = Column;
+	prepareSharedTokens(Script->tokens);
+}
+
+// FNV-1a
+uint64_t CScript::hashSource(const char *Code, size_t Size) {
+	uint64_t hash = 14695981039346656037ULL;
+	for(const unsigned char *p=(const unsigned char *)Code, *end=p+Size; p<end; ++p)
+		hash = (hash ^ *p) * 1099511628211ULL;
+	return hash;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// code cache image
+//
+//	"TJSC" version lastToken checksum sourceHash modes | strings sourceSize line column file tokens
+//
+// The fixed header is little-endian, all numbers behind it are varints (signed ones zigzag).
+// All strings are stored once in the string table and referenced by index. A token vector
+// is its size followed by the tokens, a token is token, line (relative to the previous token)
+// and column followed by its data. The data of a string token is its index - on load all
+// string tokens with the same string share one token-data. Other token-data shared by more
+// than one token (e.g. a hoisted function and its placeholder) is stored once - later uses
+// refer to it by number. The checksum covers all bytes behind it. A function stores the
+// range of its text in the source - on load the functions share one copy of the source.
+// The analyses of prepareSharedTokens are not stored - they are redone on load. The modes of
+// the tokenizer (constant folding, lazy bodies) change the tokens - an image is only loaded
+// in the modes it was saved in.
+
+#define CODE_CACHE_VERSION 5
+#define CODE_CACHE_HEADER_SIZE 28
+
+static uint32_t codeCacheModes() {
+	return (CScriptTokenizer::constantFolding ? 1 : 0) | (CScriptTokenizer::lazyFunctions ? 2 : 0);
+}
+
+// the class of the token-data of a non-simple token
+static int tokenDataKind(int tk) {
+	if(LEX_TOKEN_DATA_STRING(tk)) return 1;
+	if(LEX_TOKEN_DATA_NUMBER(tk)) return 2;
+	if(LEX_TOKEN_DATA_FUNCTION(tk)) return 3;
+	if(LEX_TOKEN_DATA_LOOP(tk)) return 4;
+	if(LEX_TOKEN_DATA_TRY(tk)) return 5;
+	if(LEX_TOKEN_DATA_OBJECT_LITERAL(tk)) return 6;
+	if(LEX_TOKEN_DATA_DESTRUCTURING_VAR(tk)) return 7;
+	if(LEX_TOKEN_DATA_SWITCH_TABLE(tk)) return 9;
+	return 8; // LEX_T_FORWARD
+}
+
+class CCodeCacheWriter {
+public:
+	CCodeCacheWriter() : line(0) {}
+	void u32(uint32_t Val) { for(int i=0; i<4; i++) image.push_back((char)(Val>>(i*8))); }
+	void u64(uint64_t Val) { u32((uint32_t)Val); u32((uint32_t)(Val>>32)); }
+	void uint(uint32_t Val) {
+		while(Val >= 0x80) { image.push_back((char)(Val | 0x80)); Val >>= 7; }
+		image.push_back((char)Val);
+	}
+	void sint(int32_t Val) { uint(((uint32_t)Val << 1) ^ (uint32_t)(Val >> 31)); }
+	void f64(double Val) { uint64_t bits; memcpy(&bits, &Val, sizeof(bits)); u64(bits); }
+	void str(const string &Str) {
+		std::pair<map<string, uint32_t>::iterator, bool> it = stringIds.insert(std::make_pair(Str, (uint32_t)strings.size()));
+		if(it.second) strings.push_back(Str);
+		uint(it.first->second);
+	}
+	template<typename T> void strs(const T &Strings) {
+		uint((uint32_t)Strings.size());
+		for(typename T::const_iterator it=Strings.begin(); it!=Strings.end(); ++it) str(*it);
+	}
+	void stringTable(const CCodeCacheWriter &Body) {
+		uint((uint32_t)Body.strings.size());
+		for(STRING_VECTOR_t::const_iterator it=Body.strings.begin(); it!=Body.strings.end(); ++it) { uint((uint32_t)it->size()); image.append(*it); }
+	}
+	void destructuring(CScriptTokenDataDestructuringVar &Var) {
+		uint((uint32_t)Var.vars.size());
+		for(DESTRUCTURING_VARS_it it=Var.vars.begin(); it!=Var.vars.end(); ++it) { str(it->first); str(it->second); }
+		tokens(Var.assignment);
+	}
+	void tokens(TOKEN_VECT &Tokens) {
+		uint((uint32_t)Tokens.size());
+		for(TOKEN_VECT_it it=Tokens.begin(); it!=Tokens.end(); ++it) token(*it);
+	}
+	void token(CScriptToken &Token);
+	string image;
+private:
+	int line;
+	STRING_VECTOR_t strings;
+	map<string, uint32_t> stringIds;
+	map<CScriptTokenData*, uint32_t> sharedIds;
+};
+void CCodeCacheWriter::token(CScriptToken &Token) {
+	int tk = Token.token;
+	uint(tk); sint(Token.line - line); uint(Token.column);
+	line = Token.line;
+	if(LEX_TOKEN_DATA_SIMPLE(tk)) {
+		sint(Token.intData);
+		return;
+	} else if(LEX_TOKEN_DATA_STRING(tk)) {
+		str(Token.String());
+		return;
+	}
+	std::pair<map<CScriptTokenData*, uint32_t>::iterator, bool> shared = sharedIds.insert(std::make_pair(Token.tokenData, (uint32_t)sharedIds.size()+1));
+	if(!shared.second) { uint(shared.first->second); return; } // already written
+	uint(0);
+	if(LEX_TOKEN_DATA_FLOAT(tk))
+		f64(Token.Float());
+	else if(tk == LEX_INT)
+		sint(Token.Number().intData);
+	else if(LEX_TOKEN_DATA_FUNCTION(tk)) {
+		CScriptTokenDataFnc &Fnc = Token.Fnc();
+		Fnc.tokenizeBody(); // the image has no source for lazy bodies
+		str(Fnc.file); sint(Fnc.line); str(Fnc.name);
+		tokens(Fnc.arguments); tokens(Fnc.body);
+		uint(Fnc.isGenerator); uint(Fnc.isArrowFunction);
+		uint((uint32_t)Fnc.sourceBegin); uint((uint32_t)Fnc.sourceEnd);
+	} else if(LEX_TOKEN_DATA_LOOP(tk)) {
+		CScriptTokenDataLoop &Loop = Token.Loop();
+		uint(Loop.type); strs(Loop.labels);
+		tokens(Loop.init); tokens(Loop.condition); tokens(Loop.iter); tokens(Loop.body);
+	} else if(LEX_TOKEN_DATA_TRY(tk)) {
+		CScriptTokenDataTry &Try = Token.Try();
+		tokens(Try.tryBlock);
+		uint((uint32_t)Try.catchBlocks.size());
+		for(CScriptTokenDataTry::CatchBlock_it it=Try.catchBlocks.begin(); it!=Try.catchBlocks.end(); ++it) {
+			uint(it->indentifiers ? 1 : 0);
+			if(it->indentifiers) destructuring(*it->indentifiers);
+			tokens(it->condition); tokens(it->block);
+		}
+		tokens(Try.finallyBlock);
+	} else if(LEX_TOKEN_DATA_OBJECT_LITERAL(tk)) {
+		CScriptTokenDataObjectLiteral &Objc = Token.Object();
+		uint(Objc.type); sint(Objc.flags); uint(Objc.destructuring); uint(Objc.structuring);
+		uint((uint32_t)Objc.elements.size());
+		for(vector<CScriptTokenDataObjectLiteral::ELEMENT>::iterator it=Objc.elements.begin(); it!=Objc.elements.end(); ++it) {
+			str(it->id); tokens(it->value);
+		}
+	} else if(LEX_TOKEN_DATA_DESTRUCTURING_VAR(tk))
+		destructuring(Token.DestructuringVar());
+	else if(LEX_TOKEN_DATA_FORWARDER(tk)) {
+		CScriptTokenDataForwards &Forwarder = Token.Forwarder();
+		for(int i=0; i<CScriptTokenDataForwards::END; i++) strs(Forwarder.varNames[i]);
+		strs(Forwarder.vars_in_letscope);
+		uint((uint32_t)Forwarder.functions.size());
+		for(CScriptTokenDataForwards::FNC_SET_it it=Forwarder.functions.begin(); it!=Forwarder.functions.end(); ++it)
+			token(const_cast<CScriptToken&>(*it));
+	} else if(LEX_TOKEN_DATA_SWITCH_TABLE(tk)) {
+		CScriptTokenDataSwitchTable &Table = Token.SwitchTable();
+		sint(Table.defaultCase);
+		uint((uint32_t)Table.numberCases.size());
+		for(CScriptTokenDataSwitchTable::NUMBER_CASES_t::iterator it=Table.numberCases.begin(); it!=Table.numberCases.end(); ++it) {
+			f64(it->first); sint(it->second);
+		}
+		uint((uint32_t)Table.stringCases.size());
+		for(CScriptTokenDataSwitchTable::STRING_CASES_t::iterator it=Table.stringCases.begin(); it!=Table.stringCases.end(); ++it) {
+			str(it->first); sint(it->second);
+		}
+	}
+}
+
+// every read is bounds-checked: a truncated or corrupted image sets ok to false and reads zeros
+class CCodeCacheReader {
+public:
+	CCodeCacheReader(const char *Image, size_t Size, const char *Code, size_t CodeSize, const CScriptTokenDataPtr<CScriptTokenDataSource> &Source) : pos((const unsigned char *)Image), end(pos+Size), ok(true), line(0), code(Code), codeSize(CodeSize), source(Source) {}
+	~CCodeCacheReader() {
+		for(vector<CScriptTokenDataString*>::iterator it=stringData.begin(); it!=stringData.end(); ++it)
+			if(*it) (*it)->unref();
+	}
+	bool need(size_t Bytes) { if(ok && (size_t)(end-pos) >= Bytes) return true; ok = false; return false; }
+	uint32_t u32() { uint32_t Val = 0; if(need(4)) for(int i=0; i<4; i++) Val |= (uint32_t)*pos++ << (i*8); return Val; }
+	uint64_t u64() { uint64_t lo = u32(); return lo | (uint64_t)u32()<<32; }
+	uint32_t uint() {
+		uint32_t Val = 0;
+		for(int shift=0; shift<35 && need(1); shift+=7) {
+			unsigned char b = *pos++;
+			Val |= (uint32_t)(b & 0x7f) << shift;
+			if(!(b & 0x80)) return Val;
+		}
+		ok = false;
+		return 0;
+	}
+	int32_t sint() { uint32_t Val = uint(); return (int32_t)(Val >> 1) ^ -(int32_t)(Val & 1); }
+	double f64() { uint64_t bits = u64(); double Val; memcpy(&Val, &bits, sizeof(Val)); return Val; }
+	uint32_t count() { uint32_t n = uint(); return need(n) ? n : 0; } ///< every element needs at least one byte
+	uint32_t strId() { uint32_t id = uint(); if(id >= strings.size()) ok = false; return ok ? id : 0; }
+	const string &str() {
+		static const string empty;
+		uint32_t id = strId();
+		return ok ? strings[id] : empty;
+	}
+	template<typename T> void strs(T &Strings) { for(uint32_t n=count(); n && ok; n--) Strings.insert(Strings.end(), str()); }
+	void stringTable() {
+		strings.resize(count());
+		stringData.resize(strings.size());
+		for(STRING_VECTOR_it it=strings.begin(); it!=strings.end() && ok; ++it) {
+			uint32_t n = count();
+			it->assign((const char *)pos, n);
+			pos += n;
+		}
+	}
+	void destructuring(CScriptTokenDataDestructuringVar &Var) {
+		for(uint32_t n=count(); n && ok; n--) { const string &first = str(); Var.vars.push_back(DESTRUCTURING_VAR_t(first, str())); }
+		tokens(Var.assignment);
+	}
+	void tokens(TOKEN_VECT &Tokens) {
+		Tokens.resize(count());
+		for(TOKEN_VECT_it it=Tokens.begin(); it!=Tokens.end() && ok; ++it) token(*it);
+	}
+	void token(CScriptToken &Token);
+	const unsigned char *pos, *end;
+	bool ok;
+private:
+	int line;
+	STRING_VECTOR_t strings;
+	vector<CScriptTokenDataString*> stringData; ///< the token-data of each string (a reference is held while loading)
+	vector<std::pair<CScriptTokenData*, int> > shared; ///< the data with its kind - owned by the tokens
+	const char *code;
+	size_t codeSize;
+	CScriptTokenDataPtr<CScriptTokenDataSource> source; ///< the source of the functions (a copy of the code is created by the first function)
+};
+void CCodeCacheReader::token(CScriptToken &Token) {
+	int tk = uint();
+	line += sint();
+	uint16_t column = uint();
+	if(tk > LEX_R_YIELD || !ok) { ok = false; return; }
+	uint16_t tokenLine = line;
+	if(LEX_TOKEN_DATA_SIMPLE(tk)) {
+		Token = CScriptToken(tk, sint());
+	} else if(LEX_TOKEN_DATA_STRING(tk)) {
+		uint32_t id = strId();
+		if(!ok) return;
+		CScriptTokenDataString *&data = stringData[id];
+		if(!data) (data = new CScriptTokenDataString(strings[id]))->ref();
+		Token.clear();
+		Token.token = tk;
+		(Token.tokenData = data)->ref();
+	} else if(uint32_t sharedId = uint()) { // the data of an earlier token
+		if(sharedId > shared.size() || shared[sharedId-1].second != tokenDataKind(tk)) { ok = false; return; }
+		Token.clear();
+		Token.token = tk;
+		(Token.tokenData = shared[sharedId-1].first)->ref();
+	} else {
+		if(LEX_TOKEN_DATA_FLOAT(tk)) {
+			Token.clear();
+			Token.token = LEX_FLOAT;
+			(Token.tokenData = new CScriptTokenDataNumber(f64()))->ref();
+		} else
+			Token = CScriptToken(tk, tk == LEX_INT ? sint() : 0);
+		shared.push_back(std::make_pair(Token.tokenData, tokenDataKind(tk)));
+		if(LEX_TOKEN_DATA_FUNCTION(tk)) {
+			CScriptTokenDataFnc &Fnc = Token.Fnc();
+			Fnc.file = str(); Fnc.line = sint(); Fnc.name = str();
+			tokens(Fnc.arguments); tokens(Fnc.body);
+			Fnc.isGenerator = uint()!=0; Fnc.isArrowFunction = uint()!=0;
+			Fnc.sourceBegin = uint(); Fnc.sourceEnd = uint();
+			if(Fnc.sourceEnd) {
+				if(Fnc.sourceBegin > Fnc.sourceEnd || Fnc.sourceEnd > codeSize) { ok = false; return; }
+				if(!source) source = CScriptTokenDataPtr<CScriptTokenDataSource>(*new CScriptTokenDataSource(code, codeSize));
+				Fnc.source = source;
+			}
+		} else if(LEX_TOKEN_DATA_LOOP(tk)) {
+			CScriptTokenDataLoop &Loop = Token.Loop();
+			switch(uint()) {
+			case CScriptTokenDataLoop::FOR_EACH:	Loop.type = CScriptTokenDataLoop::FOR_EACH; break;
+			case CScriptTokenDataLoop::FOR_IN:	Loop.type = CScriptTokenDataLoop::FOR_IN; break;
+			case CScriptTokenDataLoop::FOR_OF:	Loop.type = CScriptTokenDataLoop::FOR_OF; break;
+			case CScriptTokenDataLoop::FOR:		Loop.type = CScriptTokenDataLoop::FOR; break;
+			case CScriptTokenDataLoop::WHILE:	Loop.type = CScriptTokenDataLoop::WHILE; break;
+			case CScriptTokenDataLoop::DO:		Loop.type = CScriptTokenDataLoop::DO; break;
+			default: ok = false;
+			}
+			strs(Loop.labels);
+			tokens(Loop.init); tokens(Loop.condition); tokens(Loop.iter); tokens(Loop.body);
+		} else if(LEX_TOKEN_DATA_TRY(tk)) {
+			CScriptTokenDataTry &Try = Token.Try();
+			tokens(Try.tryBlock);
+			Try.catchBlocks.resize(count());
+			for(CScriptTokenDataTry::CatchBlock_it it=Try.catchBlocks.begin(); it!=Try.catchBlocks.end() && ok; ++it) {
+				if(uint()) {
+					it->indentifiers = CScriptTokenDataPtr<CScriptTokenDataDestructuringVar>(*new CScriptTokenDataDestructuringVar);
+					destructuring(*it->indentifiers);
+				}
+				tokens(it->condition); tokens(it->block);
+			}
+			tokens(Try.finallyBlock);
+		} else if(LEX_TOKEN_DATA_OBJECT_LITERAL(tk)) {
+			CScriptTokenDataObjectLiteral &Objc = Token.Object();
+			Objc.type = uint() ? CScriptTokenDataObjectLiteral::OBJECT : CScriptTokenDataObjectLiteral::ARRAY;
+			Objc.flags = sint(); Objc.destructuring = uint()!=0; Objc.structuring = uint()!=0;
+			Objc.elements.resize(count());
+			for(vector<CScriptTokenDataObjectLiteral::ELEMENT>::iterator it=Objc.elements.begin(); it!=Objc.elements.end() && ok; ++it) {
+				it->id = str();
+				tokens(it->value);
+			}
+		} else if(LEX_TOKEN_DATA_DESTRUCTURING_VAR(tk))
+			destructuring(Token.DestructuringVar());
+		else if(LEX_TOKEN_DATA_FORWARDER(tk)) {
+			CScriptTokenDataForwards &Forwarder = Token.Forwarder();
+			for(int i=0; i<CScriptTokenDataForwards::END; i++) strs(Forwarder.varNames[i]);
+			strs(Forwarder.vars_in_letscope);
+			for(uint32_t n=count(); n && ok; n--) {
+				CScriptToken Fnc;
+				token(Fnc);
+				if(!LEX_TOKEN_DATA_FUNCTION(Fnc.token)) { ok = false; break; }
+				Forwarder.functions.insert(Fnc);
+			}
+		} else if(LEX_TOKEN_DATA_SWITCH_TABLE(tk)) {
+			CScriptTokenDataSwitchTable &Table = Token.SwitchTable();
+			Table.defaultCase = sint();
+			for(uint32_t n=count(); n && ok; n--) {
+				double label = f64();
+				Table.numberCases[label] = sint();
+			}
+			for(uint32_t n=count(); n && ok; n--) {
+				string label = str();
+				Table.stringCases[label] = sint();
+			}
+		}
+	}
+	Token.line = tokenLine;
+	Token.column = column;
+}
+
+bool CScript::save(string &Image) const {
+	if(!isCompiled()) return false;
+	CScriptTokenDataScript &Script = *const_cast<CScript*>(this)->data;
+	CCodeCacheWriter body;
+	body.uint(Script.sourceSize);
+	body.sint(Script.line);
+	body.sint(Script.column);
+	body.str(Script.file);
+	try {
+		body.tokens(Script.tokens);
+	} catch(CScriptException *e) { // a lazy body with a syntax error - the error is thrown on its first call, not here
+		delete e;
+		return false;
+	}
+	CCodeCacheWriter head;
+	head.image.assign("TJSC");
+	head.u32(CODE_CACHE_VERSION);
+	head.u32(LEX_R_YIELD); // the token numbers must match
+	head.u32(0); // checksum
+	head.u64(Script.sourceHash);
+	head.u32(codeCacheModes());
+	head.stringTable(body);
+	Image.swap(head.image);
+	Image.append(body.image);
+	uint32_t checksum = (uint32_t)hashSource(Image.data()+CODE_CACHE_HEADER_SIZE, Image.size()-CODE_CACHE_HEADER_SIZE);
+	for(int i=0; i<4; i++) Image[12+i] = (char)(checksum >> (i*8));
+	return true;
+}
+
+CScript CScript::load(const char *Image, size_t Size, const string &Code, const string &File, int Line, int Column) {
+	return load(Image, Size, Code.c_str(), Code.size(), File, Line, Column);
+}
+CScript CScript::load(const char *Image, size_t Size, const char *Code, size_t CodeSize, const string &File, int Line, int Column) {
+	return load(Image, Size, Code, CodeSize, CScriptTokenDataPtr<CScriptTokenDataSource>(), File, Line, Column);
+}
+CScript CScript::load(const char *Image, size_t Size, const char *Code, size_t CodeSize, const CScriptTokenDataPtr<CScriptTokenDataSource> &Source, const string &File, int Line, int Column) {
+	CScript Script;
+	CCodeCacheReader reader(Image, Size, Code, CodeSize, Source);
+	if(!reader.need(CODE_CACHE_HEADER_SIZE) || memcmp(Image, "TJSC", 4) != 0) return Script;
+	reader.pos += 4;
+	if(reader.u32() != CODE_CACHE_VERSION || reader.u32() != LEX_R_YIELD) return Script;
+	if(reader.u32() != (uint32_t)hashSource(Image+CODE_CACHE_HEADER_SIZE, Size-CODE_CACHE_HEADER_SIZE)) return Script;
+	uint64_t sourceHash = hashSource(Code, CodeSize);
+	if(reader.u64() != sourceHash || reader.u32() != codeCacheModes()) return Script;
+	reader.stringTable();
+	if(reader.uint() != CodeSize || reader.sint() != Line || reader.sint() != Column || reader.str() != File || !reader.ok) return Script;
+	CScriptTokenDataScript *data = new CScriptTokenDataScript;
+	CScriptTokenDataPtr<CScriptTokenDataScript> dataPtr(*data);
+	reader.tokens(data->tokens);
+	if(!reader.ok || reader.pos != reader.end) return Script;
+	data->file = File;
+	data->sourceHash = sourceHash;
+	data->sourceSize = (uint32_t)CodeSize;
+	data->line = Line;
+	data->column = Column;
+	prepareSharedTokens(data->tokens);
+	Script.data = dataPtr;
+	return Script;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 /// CScriptVar
 //////////////////////////////////////////////////////////////////////////
@@ -2367,8 +3702,6 @@ CScriptVar::~CScriptVar(void) {
 #if DEBUG_MEMORY
 	mark_deallocated(this);
 #endif
-	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
-		(*it)->setOwner(0);
 	removeAllChildren();
 	if(prev)
 		prev->next = next;
@@ -2519,10 +3852,20 @@ CScriptVarPtr CScriptVar::toIterator(CScriptResult &execute, int Mode/*=3*/) {
 	if(!execute) return constScriptVar(Undefined);
 	if(isIterator()) return this;
 	CScriptVarFunctionPtr Generator(findChildWithPrototypeChain("__iterator__").getter(execute));
-	vector<CScriptVarPtr> args;
+	vector<CScriptVarPtr> args(1, constScriptVar(Mode==1)); // __iterator__(keysOnly)
 	if(Generator) return context->callFunction(execute, Generator, args, this);
 	return newScriptVarDefaultIterator(context, this, Mode);
 }
+bool CScriptVar::isBuiltinNext(const CScriptVarPtr &Next) { return false; }
+bool CScriptVar::iteratorNext(CScriptResult &execute, CScriptVarPtr &Value) {
+	CScriptVarFunctionPtr next(findChildWithPrototypeChain("next").getter(execute));
+	if(!execute || !next) return false;
+	vector<CScriptVarPtr> args;
+	Value = context->callFunction(execute, next, args, this);
+	if(execute.isThrow() && execute.value == constScriptVar(StopIteration))
+		execute.set(CScriptResult::Normal);
+	return execute;
+}
 
 string CScriptVar::getParsableString() {
 	uint32_t UniqueID = context->allocUniqueID();
@@ -2533,7 +3876,7 @@ string CScriptVar::getParsableString() {
 }
 
 string CScriptVar::getParsableString(const string &indentString, const string &indent, uint32_t uniqueID, bool &hasRecursion) {
-	getParsableStringRecursionsCheck();
+	// no recursions-check - primitives have no childs and the literals shares one Var
 	return indentString+toString();
 }
 
@@ -2736,24 +4079,6 @@ CScriptVarLinkPtr CScriptVar::findChildOrCreateByPath(const string &path) {
 	return l->getVarPtr()->findChildOrCreateByPath(path.substr(p+1));
 }
 
-void CScriptVar::keys(set<string> &Keys, bool OnlyEnumerable/*=true*/, uint32_t ID/*=0*/)
-{
-	if(ID) setTemporaryMark(ID);
-	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it) {
-		if(!OnlyEnumerable || (*it)->isEnumerable())
-			Keys.insert((*it)->getName());
-	}
-	CScriptVarStringPtr isStringObj = this->getRawPrimitive();
-	if(isStringObj) {
-		uint32_t length = isStringObj->stringLength();
-		for(uint32_t i=0; i<length; ++i)
-			Keys.insert(int2string(i));
-	}
-	CScriptVarLinkPtr __proto__;
-	if( ID && (__proto__ = findChild(TINYJS___PROTO___VAR)) && __proto__->getVarPtr()->getTemporaryMark() != ID )
-		__proto__->getVarPtr()->keys(Keys, OnlyEnumerable, ID);
-}
-
 /// add & remove
 CScriptVarLinkPtr CScriptVar::addChild(const string &childName, const CScriptVarPtr &child, int linkFlags /*= SCRIPTVARLINK_DEFAULT*/) {
 	CScriptVarLinkPtr link;
@@ -2790,6 +4115,7 @@ bool CScriptVar::removeLink(CScriptVarLinkPtr &link) {
 	if (!link) return false;
 	SCRIPTVAR_CHILDS_it it = lower_bound(Childs.begin(), Childs.end(), link->getName());
 	if(it != Childs.end() && (*it) == link) {
+		if(link->getOwner() == this) link->setOwner(0);
 		Childs.erase(it);
 #ifdef _DEBUG
 	} else {
@@ -2800,6 +4126,8 @@ bool CScriptVar::removeLink(CScriptVarLinkPtr &link) {
 	return true;
 }
 void CScriptVar::removeAllChildren() {
+	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
+		if((*it)->getOwner() == this) (*it)->setOwner(0); // a captured link can be owned by an other scope
 	Childs.clear();
 }
 
@@ -3037,6 +4365,11 @@ CScriptVarLinkWorkPtr CScriptVarLinkWorkPtr::setter( CScriptResult &execute, con
 /// CScriptVarPrimitive
 //////////////////////////////////////////////////////////////////////////
 
+CScriptVarPrimitive::CScriptVarPrimitive(CTinyJS *Context, const CScriptVarPtr &Prototype) : CScriptVar(Context, Prototype) {
+	setExtensible(false);
+	// the Var of a literal is shared by all its evaluations (see CTinyJS::literalScriptVar) -> __proto__ is read-only like the other properties
+	if(CScriptVarLinkPtr __proto__ = findChild(TINYJS___PROTO___VAR)) __proto__->setWritable(false);
+}
 CScriptVarPrimitive::~CScriptVarPrimitive(){}
 
 bool CScriptVarPrimitive::isPrimitive() { return true; }
@@ -3082,7 +4415,7 @@ string CScriptVarNull::getVarType() { return "null"; }
 /// CScriptVarString
 //////////////////////////////////////////////////////////////////////////
 
-CScriptVarString::CScriptVarString(CTinyJS *Context, const string &Data) : CScriptVarPrimitive(Context, Context->stringPrototype), data(Data) {
+CScriptVarString::CScriptVarString(CTinyJS *Context, const string &Data) : CScriptVarPrimitive(Context, Context->stringPrototype), data(Data), hash(0) {
 	addChild("length", newScriptVar(data.size()), SCRIPTVARLINK_CONSTANT);
 /*
 	CScriptVarLinkPtr acc = addChild("length", newScriptVar(Accessor), 0);
@@ -3118,6 +4451,16 @@ int CScriptVarString::getChar(uint32_t Idx) {
 	else
 		return (unsigned char)data[Idx];
 }
+uint32_t CScriptVarString::getHash() {
+	if(hash == 0) {
+		// FNV-1a
+		uint32_t h = 2166136261U;
+		for(string::const_iterator it=data.begin(); it!=data.end(); ++it)
+			h = (h ^ (unsigned char)*it) * 16777619U;
+		hash = h ? h : 1;
+	}
+	return hash;
+}
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -3954,34 +5297,337 @@ const char * CScriptVarRegExp::ErrorStr( int Error )
 #endif /* NO_REGEXP */
 
 
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptKeysIterator
+//////////////////////////////////////////////////////////////////////////
+
+CScriptKeysIterator::CScriptKeysIterator(const CScriptVarPtr &Object, bool OnlyEnumerable/*=true*/, bool WithPrototypes/*=false*/) {
+	start(Object, OnlyEnumerable, WithPrototypes);
+}
+void CScriptKeysIterator::start(const CScriptVarPtr &Object, bool OnlyEnumerable/*=true*/, bool WithPrototypes/*=false*/) {
+	onlyEnumerable = OnlyEnumerable;
+	withPrototypes = WithPrototypes;
+	levels.clear();
+	enterLevel(Object);
+}
+void CScriptKeysIterator::enterLevel(const CScriptVarPtr &Object) {
+	levels.push_back(Object);
+	CScriptVarStringPtr strVar = Object->getRawPrimitive();
+	charIdx = 0;
+	charCount = strVar ? strVar->stringLength() : 0;
+	pos = 0;
+	last.clear();
+}
+bool CScriptKeysIterator::isShadowed(const string &Key) {
+	for(vector<CScriptVarPtr>::iterator it = levels.begin(); it+1 < levels.end(); ++it)
+		if((*it)->findChildWithStringChars(Key)) return true;
+	return false;
+}
+bool CScriptKeysIterator::next(string &Key, CScriptVarLinkPtr *Link/*=0*/) {
+	while(!levels.empty()) {
+		CScriptVarPtr &object = levels.back();
+		while(charIdx < charCount) {
+			Key = int2string(charIdx++);
+			if(levels.size()>1 && isShadowed(Key)) continue;
+			if(Link) Link->clear();
+			return true;
+		}
+		SCRIPTVAR_CHILDS_t &Childs = object->Childs;
+		if(last && (pos > Childs.size() || !(Childs[pos-1] == last))) {
+			// Childs has changed -> continue behind the name of the last visited Child
+			SCRIPTVAR_CHILDS_it it = lower_bound(Childs.begin(), Childs.end(), last->getName());
+			if(it != Childs.end() && (*it)->getName() == last->getName()) ++it;
+			pos = it - Childs.begin();
+		}
+		while(pos < Childs.size()) {
+			last = Childs[pos++];
+			if(onlyEnumerable && !last->isEnumerable()) continue;
+			if(levels.size()>1 && isShadowed(last->getName())) continue;
+			Key = last->getName();
+			if(Link) *Link = last;
+			return true;
+		}
+		CScriptVarLinkPtr __proto__;
+		if(withPrototypes && (__proto__ = object->findChild(TINYJS___PROTO___VAR)) && 
+			find(levels.begin(), levels.end(), __proto__->getVarPtr()) == levels.end()) // prevents recursions
+			enterLevel(__proto__->getVarPtr());
+		else {
+			levels.clear();
+			last.clear();
+		}
+	}
+	return false;
+}
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarDefaultIterator
 //////////////////////////////////////////////////////////////////////////
 
 //declare_dummy_t(DefaultIterator);
 CScriptVarDefaultIterator::CScriptVarDefaultIterator(CTinyJS *Context, const CScriptVarPtr &Object, int Mode) 
-	: CScriptVarObject(Context, Context->iteratorPrototype), mode(Mode), object(Object) {
-	object->keys(keys, true);
-	pos = keys.begin();
-	addChild("next", ::newScriptVar(context, this, &CScriptVarDefaultIterator::native_next, 0));
+	: CScriptVarObject(Context, Context->iteratorPrototype), mode(Mode), object(Object), keys(Object, true, true) {
+	addChild("next", builtinNext = ::newScriptVar(context, this, &CScriptVarDefaultIterator::native_next, 0));
 }
 CScriptVarDefaultIterator::~CScriptVarDefaultIterator() {}
 CScriptVarPtr CScriptVarDefaultIterator::clone() { return new CScriptVarDefaultIterator(*this); }
 bool CScriptVarDefaultIterator::isIterator()		{return true;}
+bool CScriptVarDefaultIterator::iteratorNext(CScriptResult &execute, CScriptVarPtr &Value) {
+	return next(keys, object, mode, Value);
+}
+bool CScriptVarDefaultIterator::isBuiltinNext(const CScriptVarPtr &Next) { return Next == builtinNext; }
+bool CScriptVarDefaultIterator::next(CScriptKeysIterator &Keys, const CScriptVarPtr &Object, int Mode, CScriptVarPtr &Value) {
+	string key;
+	CScriptVarLinkPtr link;
+	if(!Keys.next(key, &link)) return false;
+	CScriptVarPtr ret0, ret1;
+	if(Mode&1) ret0 = Object->newScriptVar(key);
+	if(Mode&2) {
+		CScriptVarStringPtr strVar;
+		uint32_t idx;
+		if(link)
+			ret1 = link->getVarPtr();
+		else if((strVar = Object->getRawPrimitive()) && (idx = isArrayIndex(key)) < strVar->stringLength())
+			ret1 = Object->newScriptVar(string(1, (char)strVar->getChar(idx)));
+		else
+			ret1 = Object->findChildWithPrototypeChain(key);
+	}
+	if(Mode==3) {
+		Value = Object->newScriptVar(Array);
+		Value->setArrayIndex(0, ret0);
+		Value->setArrayIndex(1, ret1);
+	} else if(Mode==1) 
+		Value = ret0;
+	else
+		Value = ret1;
+	return true;
+}
 void CScriptVarDefaultIterator::native_next(const CFunctionsScopePtr &c, void *data) {
-	if(pos==keys.end()) throw constScriptVar(StopIteration);
-	CScriptVarPtr ret, ret0, ret1;
-	if(mode&1) ret0 = newScriptVar(*pos);
-	if(mode&2) ret1 = object->findChildWithStringChars(*pos);
-	pos++;
-	if(mode==3) {
-		ret = newScriptVar(Array);
-		ret->setArrayIndex(0, ret0);
-		ret->setArrayIndex(1, ret1);
-	} else if(mode==1) 
-		ret = ret0;
+	CScriptVarPtr ret;
+	if(!next(keys, object, mode, ret)) throw constScriptVar(StopIteration);
+	c->setReturnVar(ret);
+}
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarMap
+//////////////////////////////////////////////////////////////////////////
+
+static CScriptVarPtr &getMapPrototype(CTinyJS *Context, int Kind) {
+	switch(Kind) {
+	case CScriptVarMap::SET: return Context->setPrototype;
+	case CScriptVarMap::WEAKMAP: return Context->weakMapPrototype;
+	case CScriptVarMap::WEAKSET: return Context->weakSetPrototype;
+	default: return Context->mapPrototype;
+	}
+}
+
+//declare_dummy_t(Map);
+CScriptVarMap::CScriptVarMap(CTinyJS *Context, int Kind) 
+	: CScriptVarObject(Context, getMapPrototype(Context, Kind)), kind(Kind), used(0), iterators(0) {}
+CScriptVarMap::~CScriptVarMap() {}
+CScriptVarPtr CScriptVarMap::clone() { return new CScriptVarMap(*this); }
+void CScriptVarMap::removeAllChildren() {
+	CScriptVarObject::removeAllChildren();
+	entries.clear();
+	buckets.clear();
+	used = 0;
+}
+string CScriptVarMap::getVarTypeTagName() {
+	static const char *names[] = { "Map", "Set", "WeakMap", "WeakSet" };
+	return names[kind&3];
+}
+void CScriptVarMap::setTemporaryMark_recursive(uint32_t ID) {
+	if(getTemporaryMark() == ID) return; // a Map can contain itself
+	CScriptVarObject::setTemporaryMark_recursive(ID);
+	for(vector<ENTRY>::iterator it = entries.begin(); it!=entries.end(); ++it) {
+		if(!it->key) continue;
+		it->key->setTemporaryMark_recursive(ID);
+		it->value->setTemporaryMark_recursive(ID);
+	}
+}
+
+CScriptVarPtr CScriptVarMap::get(const CScriptVarPtr &Key) {
+	int32_t idx = findEntry(Key, getHash(Key));
+	return idx<0 ? CScriptVarPtr() : entries[idx].value;
+}
+void CScriptVarMap::set(const CScriptVarPtr &Key, const CScriptVarPtr &Value) {
+	uint32_t hash = getHash(Key);
+	int32_t idx = findEntry(Key, hash);
+	if(idx>=0) {
+		entries[idx].value = Value;
+		return;
+	}
+	// keep the load factor (removed entries included) below 3/4
+	if((entries.size()+1)*4 > buckets.size()*3) {
+		if(entries.size()-used >= used)
+			compact();
+		if((entries.size()+1)*4 > buckets.size()*3)
+			rehash(buckets.size() ? buckets.size()*2 : 8);
+	}
+	idx = entries.size();
+	entries.push_back(ENTRY());
+	ENTRY &e = entries.back();
+	// a -0 key is stored as +0
+	e.key = (Key->isNumber() && Key->toNumber().isNegativeZero()) ? newScriptVar(0) : Key;
+	e.value = Value;
+	e.hash = hash;
+	uint32_t mask = buckets.size()-1;
+	uint32_t i = hash & mask;
+	while(buckets[i] >= 0) i = (i+1) & mask;
+	buckets[i] = idx;
+	used++;
+}
+bool CScriptVarMap::remove(const CScriptVarPtr &Key) {
+	int32_t idx = findEntry(Key, getHash(Key));
+	if(idx<0) return false;
+	// the entry stays in buckets as a tombstone until the next compact
+	entries[idx].key.clear();
+	entries[idx].value.clear();
+	used--;
+	if(entries.size()-used > used && entries.size() > 16)
+		compact();
+	return true;
+}
+void CScriptVarMap::clear() {
+	if(iterators) {
+		// running iterators have to see the end; keep the positions
+		for(vector<ENTRY>::iterator it = entries.begin(); it!=entries.end(); ++it)
+			it->key.clear(), it->value.clear();
+	} else {
+		entries.clear();
+		buckets.clear();
+	}
+	used = 0;
+}
+bool CScriptVarMap::getEntry(uint32_t &Cursor, CScriptVarPtr &Key, CScriptVarPtr &Value) {
+	while(Cursor < entries.size()) {
+		ENTRY &e = entries[Cursor++];
+		if(e.key) {
+			Key = e.key;
+			Value = e.value;
+			return true;
+		}
+	}
+	return false;
+}
+
+int32_t CScriptVarMap::findEntry(const CScriptVarPtr &Key, uint32_t Hash) {
+	if(buckets.empty()) return -1;
+	uint32_t mask = buckets.size()-1;
+	for(uint32_t i = Hash & mask;; i = (i+1) & mask) {
+		int32_t idx = buckets[i];
+		if(idx < 0) return -1;
+		ENTRY &e = entries[idx];
+		if(e.hash == Hash && e.key && sameValueZero(e.key, Key)) return idx;
+	}
+}
+void CScriptVarMap::rehash(uint32_t Buckets) {
+	buckets.assign(Buckets, -1);
+	uint32_t mask = Buckets-1;
+	for(int32_t idx=0; idx<(int32_t)entries.size(); ++idx) {
+		if(!entries[idx].key) continue;
+		uint32_t i = entries[idx].hash & mask;
+		while(buckets[i] >= 0) i = (i+1) & mask;
+		buckets[i] = idx;
+	}
+}
+void CScriptVarMap::compact() {
+	if(iterators || used == entries.size()) return;
+	vector<ENTRY>::iterator dst = entries.begin();
+	for(vector<ENTRY>::iterator it = entries.begin(); it!=entries.end(); ++it) {
+		if(!it->key) continue;
+		if(dst != it) *dst = *it;
+		++dst;
+	}
+	entries.erase(dst, entries.end());
+	if(entries.empty())
+		buckets.clear();
 	else
-		ret = ret1;
+		rehash(buckets.size());
+}
+
+uint32_t CScriptVarMap::getHash(const CScriptVarPtr &Key) {
+	if(Key->isString())
+		return CScriptVarStringPtr(Key)->getHash();
+	if(Key->isNumber()) {
+		CNumber n = static_cast<CScriptVarPrimitive*>(Key.getVar())->toNumber_Callback();
+		if(n.isZero()) return 0;
+		if(n.isNaN()) return 0x7ff80000U;
+		if(n.isInfinity()) return n.isInfinity()>0 ? 0x7ff00000U : 0xfff00000U;
+		if(n.isInt32()) return (uint32_t)n.toInt32() * 2654435761U;
+		double d = n.toDouble();
+		uint32_t h[2];
+		memcpy(h, &d, sizeof(h));
+		return (h[0] ^ h[1]) * 2654435761U;
+	}
+	if(Key->isPrimitive()) {
+		if(Key->isBool()) return Key->toBoolean() ? 3 : 2;
+		return Key->isNull() ? 1 : 4; // null, undefined
+	}
+	// objects are compared by identity
+	size_t p = (size_t)Key.getVar();
+	return (uint32_t)(p ^ (p >> 16)) * 2654435761U;
+}
+bool CScriptVarMap::sameValueZero(const CScriptVarPtr &lhs, const CScriptVarPtr &rhs) {
+	if(lhs == rhs) return true;
+	if(!lhs->isPrimitive() || !rhs->isPrimitive()) return false;
+	if(lhs->isString())
+		return rhs->isString() && static_cast<CScriptVarPrimitive*>(lhs.getVar())->toCString() == static_cast<CScriptVarPrimitive*>(rhs.getVar())->toCString();
+	if(lhs->isNumber()) {
+		if(!rhs->isNumber()) return false;
+		CNumber l = static_cast<CScriptVarPrimitive*>(lhs.getVar())->toNumber_Callback();
+		CNumber r = static_cast<CScriptVarPrimitive*>(rhs.getVar())->toNumber_Callback();
+		return (l.isNaN() && r.isNaN()) || l.equal(r);
+	}
+	if(lhs->isBool())
+		return rhs->isBool() && lhs->toBoolean() == rhs->toBoolean();
+	return lhs->isNull() ? rhs->isNull() : rhs->isUndefined();
+}
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarMapIterator
+//////////////////////////////////////////////////////////////////////////
+
+//declare_dummy_t(MapIterator);
+CScriptVarMapIterator::CScriptVarMapIterator(CTinyJS *Context, const CScriptVarMapPtr &Map, int Mode) 
+	: CScriptVarObject(Context, Context->iteratorPrototype), mode(Mode), map(Map), cursor(0) {
+	map->lockIterators();
+	addChild("next", builtinNext = ::newScriptVar(context, this, &CScriptVarMapIterator::native_next, 0));
+}
+CScriptVarMapIterator::CScriptVarMapIterator(const CScriptVarMapIterator &Copy) 
+	: CScriptVarObject(Copy), mode(Copy.mode), map(Copy.map), cursor(Copy.cursor), builtinNext(Copy.builtinNext) {
+	if(map) map->lockIterators();
+}
+CScriptVarMapIterator::~CScriptVarMapIterator() {
+	if(map) map->unlockIterators();
+}
+CScriptVarPtr CScriptVarMapIterator::clone() { return new CScriptVarMapIterator(*this); }
+bool CScriptVarMapIterator::isIterator()		{return true;}
+void CScriptVarMapIterator::setTemporaryMark_recursive(uint32_t ID) {
+	CScriptVarObject::setTemporaryMark_recursive(ID);
+	if(map) map->setTemporaryMark_recursive(ID);
+}
+bool CScriptVarMapIterator::iteratorNext(CScriptResult &execute, CScriptVarPtr &Value) {
+	CScriptVarPtr key, value;
+	if(!map || !map->getEntry(cursor, key, value)) {
+		if(map) map->unlockIterators(), map.clear();
+		return false;
+	}
+	if(mode==3) {
+		Value = newScriptVar(Array);
+		Value->setArrayIndex(0, key);
+		Value->setArrayIndex(1, value);
+	} else
+		Value = mode==1 ? key : value;
+	return true;
+}
+bool CScriptVarMapIterator::isBuiltinNext(const CScriptVarPtr &Next) { return Next == builtinNext; }
+void CScriptVarMapIterator::native_next(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarPtr ret;
+	CScriptResult execute;
+	if(!iteratorNext(execute, ret)) throw constScriptVar(StopIteration);
 	c->setReturnVar(ret);
 }
 
@@ -4017,6 +5663,21 @@ CScriptVarGenerator::~CScriptVarGenerator() {
 CScriptVarPtr CScriptVarGenerator::clone() { return new CScriptVarGenerator(*this); }
 bool CScriptVarGenerator::isIterator()		{return true;}
 bool CScriptVarGenerator::isGenerator()	{return true;}
+bool CScriptVarGenerator::isBuiltinNext(const CScriptVarPtr &Next) { return Next == context->generatorPrototype_next; }
+bool CScriptVarGenerator::iteratorNext(CScriptResult &execute, CScriptVarPtr &Value) {
+	// like next() but the end is returned and not thrown
+	if(closed) return false;
+	yieldVar = constScriptVar(Undefined);
+	yieldVarIsException = false;
+	if(coroutine.next()) {
+		Value = yieldVar;
+		return true;
+	}
+	closed = true;
+	if(yieldVar != constScriptVar(StopIteration))
+		execute.set(CScriptResult::Throw, yieldVar);
+	return false;
+}
 
 string CScriptVarGenerator::getVarType() { return "generator"; }
 string CScriptVarGenerator::getVarTypeTagName() { return "Generator"; }
@@ -4121,6 +5782,8 @@ bool CScriptVarFunction::isPrimitive()	{ return false; }
 string CScriptVarFunction::getVarType() { return "function"; }
 string CScriptVarFunction::getParsableString(const string &indentString, const string &indent, uint32_t uniqueID, bool &hasRecursion) {
 	getParsableStringRecursionsCheck();
+	if(!isNative() && !isBounded() && data->hasSourceString())
+		return data->getSourceString(); // the text of the function as written
 	string destination;
 	if(!data->isArrowFunction)
 		destination.append("function ").append(data->name);
@@ -4132,6 +5795,7 @@ string CScriptVarFunction::getParsableString(const string &indentString, const s
 	if(isNative() || isBounded())
 		destination.append("{ [native code] }");
 	else {
+		data->tokenizeBody();
 		destination.append(CScriptToken::getParsableString(data->body, indentString, indent));
 	}
 	return destination;
@@ -4202,6 +5866,39 @@ CScriptVarPtr CScriptVarFunctionNativeCallback::clone() { return new CScriptVarF
 void CScriptVarFunctionNativeCallback::callFunction(const CFunctionsScopePtr &c) { jsCallback(c, jsUserData); }
 
 
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarFunctionNativeFast
+//////////////////////////////////////////////////////////////////////////
+
+CScriptVarFunctionNativeFast::~CScriptVarFunctionNativeFast() {}
+CScriptVarPtr CScriptVarFunctionNativeFast::clone() { return new CScriptVarFunctionNativeFast(*this); }
+void CScriptVarFunctionNativeFast::callFunction(const CFunctionsScopePtr &c) {
+	vector<CScriptVarPtr> Arguments;
+	int length = c->getArgumentsLength();
+	for(int i=0; i<length; ++i)
+		Arguments.push_back(c->getArgument(i));
+	CScriptVarPtr ret = callFunction(c->getArgument("this"), length ? &Arguments[0] : 0, length);
+	if(ret) c->setReturnVar(ret);
+}
+CScriptVarPtr CScriptVarFunctionNativeFast::callFunction(const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc) {
+	if(numberIntrinsic) {
+		vector<CNumber> Numbers(Argc);
+		for(size_t i=0; i<Argc; ++i)
+			Numbers[i] = Args[i]->toNumber();
+		return newScriptVar(numberIntrinsic(Argc ? &Numbers[0] : 0, Argc));
+	}
+	if(thisArgument < 0) {
+		CScriptTokenDataFnc *Fnc = getFunctionData();
+		thisArgument = Fnc->hasSimpleParameters() && Fnc->paramNames.size() && Fnc->paramNames.front() == "this" ? 1 : 0;
+	}
+	if(thisArgument) { // the static form e.g. String.charAt(this,pos) gets "this" as first argument
+		if(Argc == 0) return jsFastCallback(*context, context->constScriptVar(Undefined), Args, Argc, jsUserData);
+		return jsFastCallback(*context, Args[0], Args+1, Argc-1, jsUserData);
+	}
+	return jsFastCallback(*context, This, Args, Argc, jsUserData);
+}
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarAccessor
 //////////////////////////////////////////////////////////////////////////
@@ -4248,6 +5945,7 @@ CScriptVarLinkWorkPtr CScriptVarScope::findInScopes(const string &childName) {
 	return  CScriptVar::findChild(childName); 
 }
 CScriptVarScopePtr CScriptVarScope::getParent() { return CScriptVarScopePtr(); } ///< no Parent
+bool CScriptVarScope::hasStaticNames() { return true; }
 
 
 ////////////////////////////////////////////////////////////////////////// 
@@ -4264,6 +5962,10 @@ CScriptVarLinkWorkPtr CScriptVarScopeFnc::findInScopes(const string &childName)
 	}
 	return ret;
 }
+bool CScriptVarScopeFnc::hasStaticNames() {
+	if(dynamicNames) return false;
+	return closure ? CScriptVarScopePtr(closure)->hasStaticNames() : true;
+}
 
 void CScriptVarScopeFnc::setReturnVar(const CScriptVarPtr &var) {
 	addChildOrReplace(TINYJS_RETURN_VAR, var);
@@ -4312,6 +6014,14 @@ CScriptVarPtr CScriptVarScopeLet::scopeVar() {						// to create var like: var a
 	return getParent()->scopeVar(); 
 }
 CScriptVarScopePtr CScriptVarScopeLet::getParent() { return (CScriptVarPtr)parent; }
+void CScriptVarScopeLet::reset(const CScriptVarScopePtr &Parent) {
+	for(SCRIPTVAR_CHILDS_it it = Childs.begin(); it != Childs.end(); ++it)
+		if(!(*it == parent) && (*it)->getOwner() == this) (*it)->setOwner(0);
+	Childs.clear(); // keeps the capacity
+	letExpressionInitMode = false;
+	parent->setVarPtr(Parent);
+	if(Parent) Childs.push_back(parent);
+}
 CScriptVarLinkWorkPtr CScriptVarScopeLet::findInScopes(const string &childName) { 
 	CScriptVarLinkWorkPtr ret;
 	if(letExpressionInitMode) {
@@ -4322,6 +6032,10 @@ CScriptVarLinkWorkPtr CScriptVarScopeLet::findInScopes(const string &childName)
 	}
 	return ret;
 }
+bool CScriptVarScopeLet::hasStaticNames() {
+	CScriptVarScopePtr Parent = getParent();
+	return !letExpressionInitMode && (!Parent || Parent->hasStaticNames());
+}
 
 
 ////////////////////////////////////////////////////////////////////////// 
@@ -4346,6 +6060,30 @@ CScriptVarLinkWorkPtr CScriptVarScopeWith::findInScopes(const string &childName)
 	if( !ret ) ret = getParent()->findInScopes(childName);
 	return ret;
 }
+bool CScriptVarScopeWith::hasStaticNames() { return false; }
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarScopeClosure
+//////////////////////////////////////////////////////////////////////////
+
+declare_dummy_t(ScopeClosure);
+CScriptVarScopeClosure::CScriptVarScopeClosure(CTinyJS *Context) 
+	: CScriptVarScopeLet(Context->getRoot()) {}
+CScriptVarScopeClosure::~CScriptVarScopeClosure() {}
+CScriptVarLinkWorkPtr CScriptVarScopeClosure::findInScopes(const string &childName) { 
+	CScriptVarLinkPtr ret = findChild(childName);
+	if(ret) {
+		if(!ret->isOwned()) ret->setOwner(this); // the defining scope is gone -> the closure takes over the link
+		return ret;
+	}
+	return context->getRoot()->findChild(childName);
+}
+void CScriptVarScopeClosure::addCapturedLink(const CScriptVarLinkPtr &Link) {
+	SCRIPTVAR_CHILDS_it it = lower_bound(Childs.begin(), Childs.end(), Link->getName());
+	if(it == Childs.end() || (*it)->getName() != Link->getName())
+		Childs.insert(it, Link);
+}
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -4364,6 +6102,7 @@ CTinyJS::CTinyJS() {
 	uniqueID = 0;
 	currentMarkSlot = -1;
 	stackBase = 0;
+	argumentsPool.reserve(ARGUMENTS_POOL_SIZE);
 
 	
 	//////////////////////////////////////////////////////////////////////////
@@ -4483,16 +6222,50 @@ CTinyJS::CTinyJS() {
 	iteratorPrototype->addChild(TINYJS_CONSTRUCTOR_VAR, var, SCRIPTVARLINK_BUILDINDEFAULT);
 	pseudo_refered.push_back(&iteratorPrototype);
 
+	//////////////////////////////////////////////////////////////////////////
+	// Map, Set, WeakMap, WeakSet
+	for(int kind=0; kind<4; ++kind) {
+		static const char *names[] = { "Map", "Set", "WeakMap", "WeakSet" };
+		void *data = (void*)(size_t)kind;
+		bool isSet = (kind & CScriptVarMap::SET) != 0, isWeak = (kind & CScriptVarMap::WEAK) != 0;
+		var = addNative(string("function ")+names[kind]+"(iterable)", this, &CTinyJS::native_Map, data, SCRIPTVARLINK_CONSTANT);
+		CScriptVarPtr &prototype = getMapPrototype(this, kind);
+		prototype = var->findChild(TINYJS_PROTOTYPE_CLASS);
+		prototype->addChild(TINYJS_CONSTRUCTOR_VAR, var, SCRIPTVARLINK_BUILDINDEFAULT);
+		if(isSet)
+			prototype->addChild("add", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_set, data, "add"), SCRIPTVARLINK_BUILDINDEFAULT);
+		else {
+			prototype->addChild("get", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_get, data, "get"), SCRIPTVARLINK_BUILDINDEFAULT);
+			prototype->addChild("set", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_set, data, "set"), SCRIPTVARLINK_BUILDINDEFAULT);
+		}
+		prototype->addChild("has", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_has, data, "has"), SCRIPTVARLINK_BUILDINDEFAULT);
+		prototype->addChild("delete", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_delete, data, "delete"), SCRIPTVARLINK_BUILDINDEFAULT);
+		if(!isWeak) { // weak collections are not enumerable
+			prototype->addChild("clear", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_clear, data, "clear"), SCRIPTVARLINK_BUILDINDEFAULT);
+			prototype->addChild("forEach", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_forEach, data, "forEach"), SCRIPTVARLINK_BUILDINDEFAULT);
+			prototype->addChild("size", ::newScriptVarAccessor<CTinyJS>(this, this, &CTinyJS::native_Map_prototype_size, data, 0, 0), 0);
+			// data for iterators: kind | mode<<2 (mode 0 = __iterator__)
+			prototype->addChild("keys", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_iterator, (void*)(size_t)(kind | (isSet?2:1)<<2), "keys"), SCRIPTVARLINK_BUILDINDEFAULT);
+			prototype->addChild("values", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_iterator, (void*)(size_t)(kind | 2<<2), "values"), SCRIPTVARLINK_BUILDINDEFAULT);
+			prototype->addChild("entries", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_iterator, (void*)(size_t)(kind | 3<<2), "entries"), SCRIPTVARLINK_BUILDINDEFAULT);
+			prototype->addChild("__iterator__", ::newScriptVar(this, this, &CTinyJS::native_Map_prototype_iterator, data, "__iterator__"), SCRIPTVARLINK_BUILDINDEFAULT);
+		}
+		prototype->addChild("toString", objectPrototype_toString, SCRIPTVARLINK_BUILDINDEFAULT);
+		pseudo_refered.push_back(&prototype);
+	}
+
 	//////////////////////////////////////////////////////////////////////////
 	// Generator
 //	var = addNative("function Iterator(obj,mode)", this, &CTinyJS::native_Iterator, 0, SCRIPTVARLINK_CONSTANT); 
 #ifndef NO_GENERATORS
 	generatorPrototype = newScriptVar(Object);
-	generatorPrototype->addChild("next", ::newScriptVar(this, this, &CTinyJS::native_Generator_prototype_next, (void*)0, "Generator.next"), SCRIPTVARLINK_BUILDINDEFAULT);
+	generatorPrototype_next = ::newScriptVar(this, this, &CTinyJS::native_Generator_prototype_next, (void*)0, "Generator.next");
+	generatorPrototype->addChild("next", generatorPrototype_next, SCRIPTVARLINK_BUILDINDEFAULT);
 	generatorPrototype->addChild("send", ::newScriptVar(this, this, &CTinyJS::native_Generator_prototype_next, (void*)1, "Generator.send"), SCRIPTVARLINK_BUILDINDEFAULT);
 	generatorPrototype->addChild("close", ::newScriptVar(this, this, &CTinyJS::native_Generator_prototype_next, (void*)2, "Generator.close"), SCRIPTVARLINK_BUILDINDEFAULT);
 	generatorPrototype->addChild("throw", ::newScriptVar(this, this, &CTinyJS::native_Generator_prototype_next, (void*)3, "Generator.throw"), SCRIPTVARLINK_BUILDINDEFAULT);
 	pseudo_refered.push_back(&generatorPrototype);
+	pseudo_refered.push_back(&generatorPrototype_next);
 #endif /*NO_GENERATORS*/
 
 	//////////////////////////////////////////////////////////////////////////
@@ -4571,6 +6344,12 @@ CTinyJS::CTinyJS() {
 	// add global functions
 	addNative("function eval(jsCode)", this, &CTinyJS::native_eval);
 	native_require_read = 0;
+	native_require_source = 0;
+	codeCache = false;
+	moduleVisit = 0;
+	evalCacheSize = 64;
+	evalCacheBytes = 0;
+	evalCacheMaxBytes = 1<<20;
 	addNative("function require(jsFile)", this, &CTinyJS::native_require);
 	addNative("function isNaN(objc)", this, &CTinyJS::native_isNAN);
 	addNative("function isFinite(objc)", this, &CTinyJS::native_isFinite);
@@ -4591,6 +6370,11 @@ CTinyJS::~CTinyJS() {
 		**it = CScriptVarPtr();
 	for(int i=Error; i<ERROR_COUNT; i++)
 		errorPrototypes[i] = CScriptVarPtr();
+	letScopePool.clear();
+	clearCallSiteCache();
+	clearLiteralCache();
+	modules.clear();
+	setEvalCacheSize(0);
 	root->removeAllChildren();
 	scopes.clear();
 	ClearUnreferedVars();
@@ -4630,6 +6414,18 @@ void CTinyJS::throwException(ERROR_TYPES ErrorType, const string &message, CScri
 	throw new CScriptException(ErrorType, message, t->currentFile, Pos.currentLine(), Pos.currentColumn());
 }
 
+bool CTinyJS::tokenizeFunctionBody(CScriptResult &execute, CScriptTokenDataFnc *Fnc) {
+	try {
+		Fnc->tokenizeBody();
+	} catch(CScriptException *e) {
+		if(!execute || !haveTry) throw;
+		execute.set(CScriptResult::Throw, newScriptVarError(this, e->errorType, e->message.c_str(), e->fileName.c_str(), e->lineNumber, e->column));
+		delete e;
+		return false;
+	}
+	return true;
+}
+
 //////////////////////////////////////////////////////////////////////////
 
 void CTinyJS::trace() {
@@ -4648,6 +6444,166 @@ void CTinyJS::execute(const string &Code, const string &File, int Line, int Colu
 	evaluateComplex(Code, File, Line, Column);
 }
 
+void CTinyJS::execute(const CScript &Script) {
+	evaluateComplex(Script);
+}
+
+CScript CTinyJS::compile(const string &Code, const string &File, int Line, int Column) {
+	return CScript(Code, File, Line, Column);
+}
+
+// the tokenizer needs no context -> the workers take the next source until all are compiled
+namespace {
+	struct COMPILE_JOBS {
+		COMPILE_JOBS(const STRING_VECTOR_t &Codes, const STRING_VECTOR_t &Files, vector<CScript> &Scripts)
+			: codes(Codes), files(Files), scripts(Scripts), errors(Codes.size(), (CScriptException*)0),
+#ifdef HAVE_CXX_THREADS
+			failures(Codes.size()),
+#endif
+			next(0) {}
+		~COMPILE_JOBS() {
+			for(vector<CScriptException*>::iterator it=errors.begin(); it!=errors.end(); ++it)
+				delete *it;
+		}
+		const STRING_VECTOR_t &codes;
+		const STRING_VECTOR_t &files;
+		vector<CScript> &scripts;
+		vector<CScriptException*> errors; ///< owned until thrown
+#ifdef HAVE_CXX_THREADS
+		std::vector<std::exception_ptr> failures; ///< other exceptions must not leave a worker -> rethrown by the calling thread
+		std::atomic<size_t> next;
+#else
+		size_t next;
+#endif
+		void run() {
+			static const string noFile;
+			for(size_t i; (i = next++) < codes.size();) {
+				try {
+					scripts[i] = CScript(codes[i], i < files.size() ? files[i] : noFile);
+				} catch(CScriptException *e) {
+					errors[i] = e;
+				}
+#ifdef HAVE_CXX_THREADS
+				catch(...) {
+					failures[i] = std::current_exception();
+				}
+#endif
+			}
+		}
+	};
+#ifdef HAVE_CXX_THREADS
+	// joins the started workers also if starting a further worker throws
+	struct COMPILE_WORKERS {
+		~COMPILE_WORKERS() {
+			for(vector<std::thread>::iterator it=threads.begin(); it!=threads.end(); ++it)
+				it->join();
+		}
+		vector<std::thread> threads;
+	};
+#endif
+}
+#ifdef HAVE_CXX_THREADS
+static void compileWorker(COMPILE_JOBS *Jobs) { Jobs->run(); }
+#endif
+
+void CTinyJS::compile(const STRING_VECTOR_t &Codes, const STRING_VECTOR_t &Files, vector<CScript> &Scripts, int Threads) {
+	Scripts.assign(Codes.size(), CScript());
+	COMPILE_JOBS Jobs(Codes, Files, Scripts);
+#ifdef HAVE_CXX_THREADS
+	if(Threads <= 0) Threads = std::thread::hardware_concurrency();
+	{
+		COMPILE_WORKERS Workers;
+		Workers.threads.reserve(Threads > 1 ? Threads-1 : 0); // no reallocation between starting a thread and storing it
+		for(int i=1; i<Threads && size_t(i)<Codes.size(); i++)
+			Workers.threads.emplace_back(compileWorker, &Jobs);
+		Jobs.run(); // the calling thread is a worker too
+	}
+#else
+	Jobs.run();
+#endif
+	for(size_t i=0; i<Codes.size(); i++) {
+#ifdef HAVE_CXX_THREADS
+		if(Jobs.failures[i]) std::rethrow_exception(Jobs.failures[i]);
+#endif
+		if(CScriptException *error = Jobs.errors[i]) {
+			Jobs.errors[i] = 0; // the others are deleted by Jobs
+			throw error;
+		}
+	}
+}
+
+void CTinyJS::execute(const vector<CScript> &Scripts) {
+	for(vector<CScript>::const_iterator it=Scripts.begin(); it!=Scripts.end(); ++it)
+		execute(*it);
+}
+
+// eval and Function compile the same source texts again and again (e.g. rules or templates)
+// the compiled code of the recently used texts is kept in a LRU-list - a hit skips lexing and tokenizing
+CScript CTinyJS::compileEval(const string &Code, const string &File) {
+	if(!evalCacheSize || Code.size() > evalCacheMaxBytes/8) return CScript(Code, File); // a large text would flush the cache
+	string key(1, (char)codeCacheModes()); // the tokens depend on the modes of the tokenizer
+	key.append(File).append(1, '\0').append(Code);
+	EVAL_CACHE_INDEX_t::iterator found = evalCacheIndex.find(&key);
+	if(found != evalCacheIndex.end()) {
+		callStatistics.evalHits++;
+		evalCache.splice(evalCache.begin(), evalCache, found->second); // move to front
+		return found->second->second;
+	}
+	callStatistics.evalMisses++;
+	CScript Script(Code, File); // a syntax error is not cached
+	evalCache.push_front(make_pair(string(), Script));
+	evalCache.front().first.swap(key);
+	evalCacheIndex.insert(make_pair(&evalCache.front().first, evalCache.begin()));
+	evalCacheBytes += evalCache.front().first.size();
+	setEvalCacheSize(evalCacheSize, evalCacheMaxBytes); // drop the least recently used
+	return Script;
+}
+
+void CTinyJS::setEvalCacheSize(size_t Size, size_t MaxBytes/*=1<<20*/) {
+	evalCacheSize = Size;
+	evalCacheMaxBytes = MaxBytes;
+	while(evalCacheIndex.size() > evalCacheSize || evalCacheBytes > evalCacheMaxBytes) {
+		evalCacheBytes -= evalCache.back().first.size();
+		evalCacheIndex.erase(&evalCache.back().first);
+		evalCache.pop_back();
+	}
+}
+
+CScript CTinyJS::compileCached(const string &Code, const string &File, const string &CacheFile) {
+	return compileCached(Code.c_str(), Code.size(), File, CacheFile);
+}
+CScript CTinyJS::compileCached(const char *Code, size_t Size, const string &File, const string &CacheFile) {
+	return compileCached(Code, Size, CScriptTokenDataPtr<CScriptTokenDataSource>(), File, CacheFile);
+}
+CScript CTinyJS::compileCached(CScriptSource *Source, const string &File, const string &CacheFile) {
+	CScriptTokenDataPtr<CScriptTokenDataSource> source(*new CScriptTokenDataSource(Source));
+	return compileCached(source->code, source->size, sourceOfFunctions(source), File, CacheFile);
+}
+CScript CTinyJS::compileCached(const char *Code, size_t Size, const CScriptTokenDataPtr<CScriptTokenDataSource> &Source, const string &File, const string &CacheFile) {
+	string cacheFile = CacheFile.empty() ? File + ".tjsc" : CacheFile;
+	int ErrorNo;
+	if(CScriptSource *Image = CScriptSource::open(cacheFile, ErrorNo)) {
+		CScript Script = CScript::load(Image->data(), Image->size(), Code, Size, Source, File, 0, 0);
+		delete Image;
+		if(Script.isCompiled()) return Script;
+	}
+	CScript Script;
+	Script.compile(Code, Size, Source, File, 0, 0);
+	string Image;
+	if(Script.save(Image)) {
+		// write a temporary file and rename it -> a concurrent reader never sees a partial image
+		string tmpFile = cacheFile + ".tmp";
+		std::ofstream out(tmpFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if(out) {
+			out.write(Image.data(), Image.size());
+			out.close();
+			if(!out || (rename(tmpFile.c_str(), cacheFile.c_str()) != 0 && (remove(cacheFile.c_str()), rename(tmpFile.c_str(), cacheFile.c_str())) != 0))
+				remove(tmpFile.c_str()); // the cache is optional
+		}
+	}
+	return Script;
+}
+
 CScriptVarLinkPtr CTinyJS::evaluateComplex(CScriptTokenizer &Tokenizer) {
 	t = &Tokenizer;
 	CScriptResult execute;
@@ -4687,6 +6643,10 @@ CScriptVarLinkPtr CTinyJS::evaluateComplex(const string &Code, const string &Fil
 	CScriptTokenizer Tokenizer(Code.c_str(), File, Line, Column);
 	return evaluateComplex(Tokenizer);
 }
+CScriptVarLinkPtr CTinyJS::evaluateComplex(const CScript &Script) {
+	CScriptTokenizer Tokenizer(Script);
+	return evaluateComplex(Tokenizer);
+}
 
 string CTinyJS::evaluate(CScriptTokenizer &Tokenizer) {
 	return evaluateComplex(Tokenizer)->toString();
@@ -4697,11 +6657,26 @@ string CTinyJS::evaluate(const char *Code, const string &File, int Line, int Col
 string CTinyJS::evaluate(const string &Code, const string &File, int Line, int Column) {
 	return evaluate(Code.c_str(), File, Line, Column);
 }
+string CTinyJS::evaluate(const CScript &Script) {
+	return evaluateComplex(Script)->toString();
+}
 
 CScriptVarFunctionNativePtr CTinyJS::addNative(const string &funcDesc, JSCallback ptr, void *userdata, int LinkFlags) {
 	return addNative(funcDesc, ::newScriptVar(this, ptr, userdata), LinkFlags);
 }
 
+CScriptVarFunctionNativePtr CTinyJS::addNative(const string &funcDesc, JSFastCallback ptr, void *userdata, int LinkFlags) {
+	return addNative(funcDesc, ::newScriptVar(this, ptr, userdata), LinkFlags);
+}
+
+CScriptVarFunctionNativePtr CTinyJS::addNative(const string &funcDesc, JSNumberIntrinsic ptr, int LinkFlags) {
+	return addNative(funcDesc, ::newScriptVar(this, ptr), LinkFlags);
+}
+
+void CTinyJS::throwNativeError(ERROR_TYPES ErrorType, const string &message) {
+	throw newScriptVarError(this, ErrorType, message.c_str());
+}
+
 CScriptVarFunctionNativePtr CTinyJS::addNative(const string &funcDesc, CScriptVarFunctionNativePtr Var, int LinkFlags) {
 	CScriptLex lex(funcDesc.c_str());
 	CScriptVarPtr base = root;
@@ -4741,15 +6716,36 @@ CScriptVarLinkWorkPtr CTinyJS::parseFunctionDefinition(const CScriptToken &FncTo
 	const CScriptTokenDataFnc &Fnc = FncToken.Fnc();
 //	string fncName = (FncToken.token == LEX_T_FUNCTION_OPERATOR) ? TINYJS_TEMP_NAME : Fnc.name;
 	CScriptVarLinkWorkPtr funcVar(newScriptVar((CScriptTokenDataFnc*)&Fnc), Fnc.name);
-	if(scope() != root)
-		funcVar->getVarPtr()->addChild(TINYJS_FUNCTION_CLOSURE_VAR, scope(), 0);
+	if(scope() != root) {
+		CScriptVarPtr closure = captureClosure((CScriptTokenDataFnc&)Fnc);
+		if(closure) funcVar->getVarPtr()->addChild(TINYJS_FUNCTION_CLOSURE_VAR, closure, 0);
+	}
 	funcVar->getVarPtr()->addChild(TINYJS_PROTOTYPE_CLASS, newScriptVar(Object), SCRIPTVARLINK_WRITABLE)->getVarPtr()->addChild(TINYJS_CONSTRUCTOR_VAR, funcVar->getVarPtr(), SCRIPTVARLINK_WRITABLE);
 	return funcVar;
 }
 
+// the closure of a function holds only the links of the names used by the function 
+// globals are found at call time in root - the whole scope chain is only kept if the names are not predictable
+CScriptVarPtr CTinyJS::captureClosure(CScriptTokenDataFnc &Fnc) {
+	if(Fnc.capture == CScriptTokenDataFnc::CAPTURE_UNKNOWN) Fnc.analyzeCapture();
+	if(Fnc.capture == CScriptTokenDataFnc::CAPTURE_SCOPE || !scope()->hasStaticNames()) return scope();
+	CScriptVarScopeClosurePtr closure;
+	for(STRING_VECTOR_it it = Fnc.captureNames.begin(); it != Fnc.captureNames.end(); ++it) {
+		CScriptVarLinkWorkPtr link = scope()->findInScopes(*it);
+		if(!link || link->getOwner() == root.getVar()) continue; // global or not defined
+		if(!link->isOwned()) return scope();
+		if(!closure) closure = ::newScriptVar(this, ScopeClosure);
+		closure->addCapturedLink(link);
+	}
+	return closure;
+}
+
 CScriptVarLinkWorkPtr CTinyJS::parseFunctionsBodyFromString(const string &ArgumentList, const string &FncBody) {
-	string Fnc = "function ("+ArgumentList+"){"+FncBody+"}";
-	CScriptTokenizer tokenizer(Fnc.c_str());
+	// the parentheses make it a function expression - a function statement requires a name
+	string Fnc = "(function ("+ArgumentList+"){"+FncBody+"\n})";
+	CScriptTokenizer tokenizer(compileEval(Fnc, "Function"));
+	tokenizer.match(LEX_T_SKIP); // skip the expression statement
+	tokenizer.match('(');
 	return parseFunctionDefinition(tokenizer.getToken());
 }
 CScriptVarPtr CTinyJS::callFunction(const CScriptVarFunctionPtr &Function, vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis) {
@@ -4764,8 +6760,16 @@ CScriptVarPtr CTinyJS::callFunction(CScriptResult &execute, const CScriptVarFunc
 
 	if(Function->isBounded()) return CScriptVarFunctionBoundedPtr(Function)->callFunction(execute, Arguments, This, newThis);
 
+	if(Function->isNative()) {
+		CScriptVarFunctionNativeFast *fast = dynamic_cast<CScriptVarFunctionNativeFast*>(Function.getVar());
+		if(fast) return callFunctionFast(execute, fast, Arguments, This, newThis);
+	}
 	CScriptTokenDataFnc *Fnc = Function->getFunctionData();
+	if(Fnc->isLazy() && !tokenizeFunctionBody(execute, Fnc)) return constScriptVar(Undefined);
+	if(Fnc->hasSimpleParameters()) return callFunctionDirect(execute, Function, Fnc, Arguments, This, newThis);
 	CScriptVarScopeFncPtr functionRoot(::newScriptVar(this, ScopeFnc, CScriptVarPtr(Function->findChild(TINYJS_FUNCTION_CLOSURE_VAR))));
+	if(Fnc->capture == CScriptTokenDataFnc::CAPTURE_UNKNOWN) Fnc->analyzeCapture(); // a function defined in root is not analyzed on creation
+	if(Fnc->capture == CScriptTokenDataFnc::CAPTURE_SCOPE) functionRoot->setDynamicNames(); // the closures created in it keep the whole scope
 	if(Fnc->name.size()) functionRoot->addChild(Fnc->name, Function);
 	if(!Fnc->isArrowFunction)
 		functionRoot->addChild("this", This);
@@ -4774,7 +6778,6 @@ CScriptVarPtr CTinyJS::callFunction(CScriptResult &execute, const CScriptVarFunc
 	CScopeControl ScopeControl(this);
 	CScriptVarPtr tmpArgsScope = ScopeControl.addLetScope();
 
-	CScriptResult function_execute;
 	int length_proto = Fnc->arguments.size();
 	int length_arguments = Arguments.size();
 	int length = max(length_proto, length_arguments);
@@ -4819,8 +6822,63 @@ CScriptVarPtr CTinyJS::callFunction(CScriptResult &execute, const CScriptVarFunc
 		return ::newScriptVarCScriptVarGenerator(this, functionRoot, Function);
 	} 
 #endif /*NO_GENERATORS*/
-	// execute function!
 	ScopeControl.clear(); 	// remove tmpArgsScope from scope-chain
+	return callFunctionBody(execute, Function, Fnc, functionRoot, newThis);
+}
+
+// functions with simple parameters (no default values, no destructuring) need no arguments-scope
+// -> the arguments are assigned directly into the function's scope
+CScriptVarPtr CTinyJS::callFunctionDirect(CScriptResult &execute, const CScriptVarFunctionPtr &Function, CScriptTokenDataFnc *Fnc, vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis) {
+	callStatistics.directCalls++;
+	CScriptVarScopeFncPtr functionRoot(::newScriptVar(this, ScopeFnc, CScriptVarPtr(Function->findChild(TINYJS_FUNCTION_CLOSURE_VAR))));
+	if(Fnc->capture == CScriptTokenDataFnc::CAPTURE_UNKNOWN) Fnc->analyzeCapture(); // a function defined in root is not analyzed on creation
+	if(Fnc->capture == CScriptTokenDataFnc::CAPTURE_SCOPE) functionRoot->setDynamicNames(); // the closures created in it keep the whole scope
+	if(Fnc->name.size()) functionRoot->addChild(Fnc->name, Function);
+	if(!Fnc->isArrowFunction)
+		functionRoot->addChild("this", This);
+	CScriptVarPtr arguments = functionRoot->addChild(TINYJS_ARGUMENTS_VAR, newScriptVar(Object));
+
+	int length_proto = Fnc->paramNames.size();
+	int length_arguments = Arguments.size();
+	for(int arguments_idx = 0; arguments_idx<length_arguments; ++arguments_idx)
+		arguments->addChild(int2string(arguments_idx), Arguments[arguments_idx]);
+	arguments->addChild("length", newScriptVar(length_arguments));
+	for(int arguments_idx = 0; arguments_idx<length_proto; ++arguments_idx)
+		functionRoot->addChildOrReplace(Fnc->paramNames[arguments_idx], arguments_idx < length_arguments ? Arguments[arguments_idx] : constUndefined);
+
+	return callFunctionBody(execute, Function, Fnc, functionRoot, newThis);
+}
+
+// native functions with the fast calling convention get the arguments as array - no function scope is needed
+CScriptVarPtr CTinyJS::callFunctionFast(CScriptResult &execute, CScriptVarFunctionNativeFast *Function, vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis) {
+	callStatistics.fastCalls++;
+	try {
+		CScriptVarPtr ret = Function->callFunction(This, Arguments.size() ? &Arguments[0] : 0, Arguments.size());
+		if(newThis) *newThis = This;
+		if(ret) return ret;
+	} catch (CScriptVarPtr v) {
+		nativeException(execute, v, Function->getFunctionData()->name);
+	}
+	return constUndefined;
+}
+
+// an exception thrown by a native function is catchable in a try-block otherwise it ends the script
+void CTinyJS::nativeException(CScriptResult &execute, const CScriptVarPtr &Exception, const string &FunctionName) {
+	if(haveTry) {
+		execute.setThrow(Exception, "native function '"+FunctionName+"'");
+	} else if(Exception->isError()) {
+		CScriptException *err = CScriptVarErrorPtr(Exception)->toCScriptException();
+		if(err->fileName.empty()) err->fileName = "native function '"+FunctionName+"'";
+		throw err;
+	}
+	else
+		throw new CScriptException(Error, "uncaught exception: '"+Exception->toString(execute)+"' in native function '"+FunctionName+"'");
+}
+
+CScriptVarPtr CTinyJS::callFunctionBody(CScriptResult &execute, const CScriptVarFunctionPtr &Function, CScriptTokenDataFnc *Fnc, const CScriptVarScopeFncPtr &functionRoot, CScriptVarPtr *newThis) {
+	// execute function!
+	CScriptResult function_execute;
+	CScopeControl ScopeControl(this);
 	// add the function's execute space to the symbol table so we can recurse
 	ScopeControl.addFncScope(functionRoot);
 	if (Function->isNative()) {
@@ -4829,15 +6887,7 @@ CScriptVarPtr CTinyJS::callFunction(CScriptResult &execute, const CScriptVarFunc
 			CScriptVarLinkPtr ret = functionRoot->findChild(TINYJS_RETURN_VAR);
 			function_execute.set(CScriptResult::Return, ret ? CScriptVarPtr(ret) : constUndefined);
 		} catch (CScriptVarPtr v) {
-			if(haveTry) {
-				function_execute.setThrow(v, "native function '"+Fnc->name+"'");
-			} else if(v->isError()) {
-				CScriptException *err = CScriptVarErrorPtr(v)->toCScriptException();
-				if(err->fileName.empty()) err->fileName = "native function '"+Fnc->name+"'";
-				throw err;
-			}
-			else
-				throw new CScriptException(Error, "uncaught exception: '"+v->toString(function_execute)+"' in native function '"+Fnc->name+"'");
+			nativeException(function_execute, v, Fnc->name);
 		}
 	} else {
 		/* we just want to execute the block, but something could
@@ -5223,6 +7273,23 @@ void CTinyJS::execute_destructuring(CScriptResult &execute, CScriptTokenDataObje
 	}
 }
 
+// returns the immutable Var of a number- or string-literal - cached by the serial of the literal
+CScriptVarPtr CTinyJS::literalScriptVar(CScriptToken &Token) {
+	uint32_t serial = Token.Literal().getSerial();
+	LITERAL &cached = literalCache[serial & (LITERAL_CACHE_SIZE-1)];
+	if(cached.serial == serial) return cached.var;
+	CScriptVarPtr var;
+	if(Token.token == LEX_INT)
+		var = newScriptVar(Token.Number().intData);
+	else if(Token.token == LEX_FLOAT)
+		var = newScriptVar(Token.Number().floatData);
+	else
+		var = newScriptVar(Token.String());
+	cached.serial = serial;
+	cached.var = var;
+	return var;
+}
+
 CScriptVarLinkWorkPtr CTinyJS::execute_literals(CScriptResult &execute) {
 	switch(t->tk) {
 	case LEX_ID: 
@@ -5247,24 +7314,11 @@ CScriptVarLinkWorkPtr CTinyJS::execute_literals(CScriptResult &execute) {
 		t->match(LEX_ID);
 		break;
 	case LEX_INT:
-		{
-			CScriptVarPtr a = newScriptVar(t->getToken().Int());
-			a->setExtensible(false);
-			t->match(LEX_INT);
-			return a;
-		}
-		break;
 	case LEX_FLOAT:
-		{
-			CScriptVarPtr a = newScriptVar(t->getToken().Float());
-			t->match(LEX_FLOAT);
-			return a;
-		}
-		break;
 	case LEX_STR:
 		{
-			CScriptVarPtr a = newScriptVar(t->getToken().String());
-			t->match(LEX_STR);
+			CScriptVarPtr a = literalScriptVar(t->getToken());
+			t->match(t->tk);
 			return a;
 		}
 		break;
@@ -5291,6 +7345,12 @@ CScriptVarLinkWorkPtr CTinyJS::execute_literals(CScriptResult &execute) {
 				return a;
 			} else {
 				CScriptVarPtr a = Objc.type==CScriptTokenDataObjectLiteral::OBJECT ? newScriptVar(Object) : newScriptVar(Array);
+				if(Objc.boilerplateState == CScriptTokenDataObjectLiteral::BOILERPLATE_NONE)
+					Objc.buildBoilerplate();
+				if(Objc.boilerplateState == CScriptTokenDataObjectLiteral::BOILERPLATE_READY) {
+					execute_literal_boilerplate(execute, Objc, a);
+					return a;
+				}
 				for(vector<CScriptTokenDataObjectLiteral::ELEMENT>::iterator it=Objc.elements.begin(); execute && it!=Objc.elements.end(); ++it) {
 					if(it->value.empty()) continue;
 					CScriptToken &tk = it->value.front();
@@ -5376,14 +7436,20 @@ CScriptVarLinkWorkPtr CTinyJS::execute_literals(CScriptResult &execute) {
 					}
 					vector<CScriptVarPtr> arguments;
 					if (t->tk == '(') {
+						CScriptTokenizer::ScriptTokenPosition argumentsPos = t->getPos(); // '(' holds the skip-offset behind ')'
 						t->match('(');
 						while(t->tk!=')') {
 							CScriptVarPtr value = execute_assignment(execute).getter(execute);
-							if (execute)
-								arguments.push_back(value);
+							if (!execute) break;
+							arguments.push_back(value);
 							if (t->tk!=')') t->match(',', ')');
 						}
-						t->match(')');
+						if(execute)
+							t->match(')');
+						else { // an argument breaks the execution -> jump over the remaining arguments
+							t->setPos(argumentsPos);
+							t->skip(t->getToken().Int());
+						}
 					}
 					if(execute) {
 						CScriptVarPtr returnVar = callFunction(execute, Constructor, arguments, obj, &obj);
@@ -5427,6 +7493,78 @@ CScriptVarLinkWorkPtr CTinyJS::execute_literals(CScriptResult &execute) {
 	return constScriptVar(Undefined);
 
 }
+void CTinyJS::execute_literal_boilerplate(CScriptResult &execute, CScriptTokenDataObjectLiteral &Objc, const CScriptVarPtr &Obj) {
+	typedef vector<CScriptTokenDataObjectLiteral::SLOT>::iterator SLOT_it;
+	// the constant values are created from their token
+	vector<CScriptVarPtr> values(Objc.elements.size());
+	for(SLOT_it it=Objc.boilerplate.begin(); it!=Objc.boilerplate.end(); ++it)
+		if(it->constToken) {
+			CScriptToken &tk = Objc.elements[it->element].value.front();
+			switch(it->constToken) {
+			case LEX_INT:
+			case LEX_FLOAT:
+			case LEX_STR: values[it->element] = literalScriptVar(tk); break;
+			case LEX_R_TRUE: values[it->element] = constScriptVar(true); break;
+			case LEX_R_FALSE: values[it->element] = constScriptVar(false); break;
+			default: values[it->element] = constScriptVar(Null); break;
+			}
+		}
+	// evaluate the non constant values in source order
+	for(vector<CScriptTokenDataObjectLiteral::ELEMENT>::iterator it=Objc.elements.begin(); it!=Objc.elements.end(); ++it) {
+		if(it->value.empty() || values[it-Objc.elements.begin()]) continue;
+		t->pushTokenScope(it->value);
+		CScriptVarPtr value = execute_assignment(execute);
+		if(!execute) return;
+		values[it-Objc.elements.begin()] = value;
+	}
+	// merge the presorted slots with the Childs of the new object (__proto__, length) in one pass
+	SCRIPTVAR_CHILDS_t &base = Obj->Childs;
+	SCRIPTVAR_CHILDS_t childs;
+	childs.reserve(base.size() + Objc.boilerplate.size());
+	SCRIPTVAR_CHILDS_it b = base.begin();
+	for(SLOT_it it=Objc.boilerplate.begin(); it!=Objc.boilerplate.end(); ++it) {
+		while(b != base.end() && *b < it->name) childs.push_back(*b++);
+		if(b != base.end() && (*b)->getName() == it->name) {
+			(*b)->setVarPtr(values[it->element]);
+			childs.push_back(*b++);
+		} else {
+			CScriptVarLinkPtr link(values[it->element], it->name);
+			link->setOwner(Obj.getVar());
+			childs.push_back(link);
+		}
+	}
+	childs.insert(childs.end(), b, base.end());
+	base.swap(childs);
+}
+
+// merge the presorted slots of a forwarder with the Childs of the scope in one pass
+// existing names are kept, hoisted functions replace the value
+void CTinyJS::execute_scope_template(const CScriptVarPtr &Scope, CScriptTokenDataForwards::SLOTS_t &Slots) {
+	if(Slots.empty()) return;
+	SCRIPTVAR_CHILDS_t &base = Scope->Childs;
+	SCRIPTVAR_CHILDS_t childs;
+	childs.reserve(base.size() + Slots.size());
+	vector<pair<CScriptVarLinkPtr, const CScriptToken*> > functions;
+	SCRIPTVAR_CHILDS_it b = base.begin();
+	for(CScriptTokenDataForwards::SLOTS_it it=Slots.begin(); it!=Slots.end(); ++it) {
+		while(b != base.end() && *b < it->name) childs.push_back(*b++);
+		if(b != base.end() && (*b)->getName() == it->name) {
+			if(it->fnc) functions.push_back(make_pair(*b, it->fnc));
+			childs.push_back(*b++);
+		} else {
+			CScriptVarLinkPtr link(constScriptVar(Undefined), it->name, it->flags);
+			link->setOwner(Scope.getVar());
+			if(it->fnc) functions.push_back(make_pair(link, it->fnc));
+			childs.push_back(link);
+		}
+	}
+	childs.insert(childs.end(), b, base.end());
+	base.swap(childs);
+	// the functions are created when all names exist -> the closures can capture the names of this scope
+	for(vector<pair<CScriptVarLinkPtr, const CScriptToken*> >::iterator it=functions.begin(); it!=functions.end(); ++it)
+		it->first->setVarPtr(parseFunctionDefinition(*it->second)->getVarPtr());
+}
+
 CScriptVarLinkWorkPtr CTinyJS::execute_member(CScriptVarLinkWorkPtr &parent, CScriptResult &execute) {
 	CScriptVarLinkWorkPtr a;
 	parent.swap(a);
@@ -5471,27 +7609,56 @@ CScriptVarLinkWorkPtr CTinyJS::execute_function_call(CScriptResult &execute) {
 			if(a->getVarPtr()->isUndefined() || a->getVarPtr()->isNull())
 				throwError(execute, ReferenceError, a->getName() + " is " + a->toString(execute));
 			CScriptVarPtr fnc = a.getter(execute)->getVarPtr();
-			if (!fnc->isFunction())
+			// the '(' identifies the call-site - a monomorphic call-site knows the kind of the function
+			const CScriptToken *site = &t->getToken();
+			CALLSITE &callSite = callSiteCache[(reinterpret_cast<size_t>(site) / sizeof(CScriptToken)) & (CALLSITE_CACHE_SIZE-1)];
+			callStatistics.calls++;
+			if(callSite.site == site && callSite.function.getVar() == fnc.getVar())
+				callStatistics.hits++;
+			else if (!fnc->isFunction())
 				throwError(execute, TypeError, a->getName() + " is not a function");
+			else {
+				callStatistics.misses++;
+				callSite.site = site;
+				callSite.function = fnc;
+				callSite.fnc = fnc->getFunctionData();
+				if(fnc->isBounded())
+					callSite.kind = CALLSITE::CALL_FUNCTION;
+				else if(fnc->isNative() && dynamic_cast<CScriptVarFunctionNativeFast*>(fnc.getVar()))
+					callSite.kind = static_cast<CScriptVarFunctionNativeFast*>(fnc.getVar())->getNumberIntrinsic() ? CALLSITE::CALL_INTRINSIC : CALLSITE::CALL_FAST;
+				else if(tokenizeFunctionBody(execute, callSite.fnc))
+					callSite.kind = callSite.fnc->hasSimpleParameters() ? CALLSITE::CALL_DIRECT : CALLSITE::CALL_FUNCTION;
+				else
+					callSite.kind = CALLSITE::CALL_FUNCTION;
+			}
+			// the arguments can contain calls that replace the cache entry
+			int kind = callSite.kind;
+			CScriptTokenDataFnc *Fnc = callSite.fnc;
 			if (stackBase) {
 				int dummy;
 				if(&dummy < stackBase)
 					throwError(execute, Error, "too much recursion");
 			}
 
+			CScriptTokenizer::ScriptTokenPosition argumentsPos = t->getPos(); // '(' holds the skip-offset behind ')'
 			t->match('('); // path += '(';
 
 			// grab in all parameters
-			vector<CScriptVarPtr> arguments;
+			CArgumentsBuffer argumentsBuffer(this);
+			vector<CScriptVarPtr> &arguments = argumentsBuffer.arguments;
 			while(t->tk!=')') {
 				CScriptVarLinkWorkPtr value = execute_assignment(execute).getter(execute);
 //				path += (*value)->getString();
-				if (execute) {
-					arguments.push_back(value);
-				}
+				if (!execute) break;
+				arguments.push_back(value);
 				if (t->tk!=')') { t->match(','); /*path+=',';*/ }
 			}
-			t->match(')'); //path+=')';
+			if(execute)
+				t->match(')'); //path+=')';
+			else { // an argument breaks the execution -> jump over the remaining arguments
+				t->setPos(argumentsPos);
+				t->skip(t->getToken().Int());
+			}
 			// setup a return variable
 			CScriptVarLinkWorkPtr returnVar;
 			if(execute) {
@@ -5499,16 +7666,26 @@ CScriptVarLinkWorkPtr CTinyJS::execute_function_call(CScriptResult &execute) {
 					parent = findInScopes("this");
 				// if no parent use the root-scope
 				CScriptVarPtr This(parent ? parent->getVarPtr() : (CScriptVarPtr )root);
-				a = callFunction(execute, fnc, arguments, This);
+				if(kind == CALLSITE::CALL_INTRINSIC && arguments.size() <= INTRINSIC_MAX_ARGS) {
+					// the call-site guards that fnc is still the original intrinsic e.g. Math.floor
+					CNumber numbers[INTRINSIC_MAX_ARGS];
+					size_t argc = arguments.size();
+					for(size_t i=0; execute && i<argc; ++i)
+						numbers[i] = arguments[i]->toNumber(execute);
+					if(execute) {
+						callStatistics.intrinsicCalls++;
+						a = newScriptVar(static_cast<CScriptVarFunctionNativeFast*>(fnc.getVar())->getNumberIntrinsic()(numbers, argc));
+					}
+				} else if(kind >= CALLSITE::CALL_FAST)
+					a = callFunctionFast(execute, static_cast<CScriptVarFunctionNativeFast*>(fnc.getVar()), arguments, This, 0);
+				else if(kind == CALLSITE::CALL_DIRECT)
+					a = callFunctionDirect(execute, fnc, Fnc, arguments, This, 0);
+				else
+					a = callFunction(execute, fnc, arguments, This);
 			}
 		} else {
-			// function, but not executing - just parse args and be done
-			t->match('(');
-			while (t->tk != ')') {
-				CScriptVarLinkWorkPtr value = execute_base(execute);
-				//	if (t->tk!=')') t->match(',');
-			}
-			t->match(')');
+			// function, but not executing - just skip args and be done
+			t->skip(t->getToken().Int());
 		}
 		a = execute_member(parent = a, execute);
 	}
@@ -5865,20 +8042,10 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 		break;
 	case LEX_T_FORWARD:
 		{
-			CScriptVarPtr in_scope = scope()->scopeLet();
-			STRING_SET_t *varNames = t->getToken().Forwarder().varNames;
-			for(int i=0; i<CScriptTokenDataForwards::END; ++i) {
-				for(STRING_SET_it it=varNames[i].begin(); it!=varNames[i].end(); ++it) {
-					CScriptVarLinkPtr a = in_scope->findChild(*it);
-					if(!a) in_scope->addChild(*it, constScriptVar(Undefined), i==CScriptTokenDataForwards::CONSTS ? SCRIPTVARLINK_CONSTDEFAULT : SCRIPTVARLINK_VARDEFAULT);
-				}
-					in_scope = scope()->scopeVar();
-			}
-			CScriptTokenDataForwards::FNC_SET_t &functions = t->getToken().Forwarder().functions;
-			for(CScriptTokenDataForwards::FNC_SET_it it=functions.begin(); it!=functions.end(); ++it) {
-				CScriptVarLinkWorkPtr funcVar = parseFunctionDefinition(*it);
-				in_scope->addChildOrReplace(funcVar->getName(), funcVar, SCRIPTVARLINK_VARDEFAULT);
-			}
+			CScriptTokenDataForwards &Forwarder = t->getToken().Forwarder();
+			if(!Forwarder.scopeTemplateReady) Forwarder.buildScopeTemplate();
+			execute_scope_template(scope()->scopeLet(), Forwarder.letSlots);
+			execute_scope_template(scope()->scopeVar(), Forwarder.varSlots);
 			t->match(LEX_T_FORWARD);
 		}
 		break;
@@ -5961,17 +8128,43 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 
 			if(!execute) break;
 
-			CScriptVarPtr Iterator(for_in_var->toIterator(execute, LoopData.type!=CScriptTokenDataLoop::FOR_IN ? 2:1));
-			CScriptVarFunctionPtr Iterator_next(Iterator->findChildWithPrototypeChain("next").getter(execute));
-			if(execute && !Iterator_next) throwError(execute, TypeError, "'" + for_in_var->toString(execute) + "' is not iterable", t->getPrevPos());
-			if(!execute) break;
+			int Mode = LoopData.type!=CScriptTokenDataLoop::FOR_IN ? 2:1;
+			// objects without an own iteration are walked with an internal cursor (no iterator object)
+			bool defaultIteration = !for_in_var->isIterator() && !for_in_var->findChildWithPrototypeChain("__iterator__");
+			CScriptKeysIterator Keys;
+			CScriptVarPtr Iterator;
+			CScriptVarFunctionPtr Iterator_next;
+			if(defaultIteration)
+				Keys.start(for_in_var, true, true);
+			else {
+				Iterator = for_in_var->toIterator(execute, Mode);
+				Iterator_next = Iterator->findChildWithPrototypeChain("next").getter(execute);
+				if(execute && !Iterator_next) throwError(execute, TypeError, "'" + for_in_var->toString(execute) + "' is not iterable", t->getPrevPos());
+				if(!execute) break;
+			}
+			// builtin iterators are stepped native (the end is returned and not thrown) - unless the script has replaced their next
+			bool nativeNext = defaultIteration || Iterator->isBuiltinNext(Iterator_next);
+			vector<CScriptVarPtr> args;
 			CScriptResult tmp_execute;
 			for(;;) {
 				bool old_haveTry = haveTry;
 				haveTry = true;
-				tmp_execute.set(CScriptResult::Normal, Iterator);
-				t->pushTokenScope(LoopData.condition);
-				execute_statement(tmp_execute);
+				tmp_execute.set(CScriptResult::Normal);
+				CScriptVarPtr value;
+				bool haveValue;
+				if(defaultIteration)
+					haveValue = CScriptVarDefaultIterator::next(Keys, for_in_var, Mode, value);
+				else if(nativeNext)
+					haveValue = Iterator->iteratorNext(tmp_execute, value);
+				else {
+					value = callFunction(tmp_execute, Iterator_next, args, Iterator);
+					haveValue = tmp_execute;
+				}
+				if(haveValue) {
+					tmp_execute.set(CScriptResult::Normal, value);
+					t->pushTokenScope(LoopData.condition);
+					execute_statement(tmp_execute);
+				}
 				haveTry = old_haveTry;
 				if(tmp_execute.isThrow()){
 					if(tmp_execute.value != constStopIteration) {
@@ -5982,6 +8175,7 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 					}
 					break;
 				}
+				if(!haveValue) break;
 				t->pushTokenScope(LoopData.body);
 				execute_statement(execute);
 				if(!execute) {
@@ -6166,6 +8360,23 @@ void CTinyJS::execute_statement(CScriptResult &execute) {
 				}
 				CScriptTokenizer::ScriptTokenPosition defaultStart = t->getPos();
 				bool hasDefault = false, found = false;
+				if(t->tk == LEX_T_SWITCH_TABLE) { // only literals as case labels -> jump to the ':' of the case (or to the '}')
+					CScriptTokenDataSwitchTable &Table = t->getToken().SwitchTable();
+					int offset = Table.defaultCase;
+					if(SwitchValue->isString()) {
+						CScriptTokenDataSwitchTable::STRING_CASES_t::iterator it = Table.stringCases.find(SwitchValue->toString());
+						if(it != Table.stringCases.end()) offset = it->second;
+					} else if(SwitchValue->isNumber()) {
+						CNumber number = SwitchValue->toNumber();
+						CScriptTokenDataSwitchTable::NUMBER_CASES_t::iterator it = number.isNaN() ? Table.numberCases.end() : Table.numberCases.find(number.toDouble());
+						if(it != Table.numberCases.end()) offset = it->second;
+					}
+					t->skip(offset);
+					if(t->tk == ':') {
+						found = true;
+						t->match(':');
+					}
+				}
 				while (t->tk) {
 					switch(t->tk) {
 					case LEX_R_CASE:
@@ -6270,6 +8481,32 @@ CScriptVarLinkPtr CTinyJS::findInScopes(const string &childName) {
 	return scope()->findInScopes(childName);
 }
 
+CScriptVarScopeLetPtr CTinyJS::newLetScope(const CScriptVarScopePtr &Parent) {
+	if(letScopePool.empty())
+		return ::newScriptVar(this, ScopeLet, Parent);
+	CScriptVarScopeLetPtr scope = letScopePool.back();
+	letScopePool.pop_back();
+	scope->reset(Parent);
+	return scope;
+}
+void CTinyJS::clearCallSiteCache() {
+	for(int i=0; i<CALLSITE_CACHE_SIZE; ++i)
+		callSiteCache[i] = CALLSITE();
+}
+void CTinyJS::clearLiteralCache() {
+	for(int i=0; i<LITERAL_CACHE_SIZE; ++i)
+		literalCache[i] = LITERAL();
+}
+// a left let-scope is only reused if nothing else holds it
+// (no closure, eval, generator or nested scope has captured it)
+void CTinyJS::recycleLetScope(CScriptVarScopePtr &Scope) {
+	if(Scope->getRefs() != 1 || letScopePool.size() >= 16) return;
+	CScriptVarScopeLet *let = dynamic_cast<CScriptVarScopeLet*>(Scope.getVar());
+	if(!let || dynamic_cast<CScriptVarScopeWith*>(let) || dynamic_cast<CScriptVarScopeClosure*>(let)) return;
+	let->reset(CScriptVarScopePtr());
+	letScopePool.push_back(let);
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// Object
 //////////////////////////////////////////////////////////////////////////
@@ -6319,12 +8556,11 @@ void CTinyJS::native_Object_keys(const CFunctionsScopePtr &c, void *data) {
 	CScriptVarPtr returnVar = c->newScriptVar(Array);
 	c->setReturnVar(returnVar);
 
-	STRING_SET_t keys;
-	obj->keys(keys, data==0);
-
+	CScriptKeysIterator keys(obj, data==0);
+	string key;
 	uint32_t idx=0;
-	for(STRING_SET_it it=keys.begin(); it!=keys.end(); ++it)
-		returnVar->setArrayIndex(idx++, newScriptVar(*it));
+	while(keys.next(key))
+		returnVar->setArrayIndex(idx++, newScriptVar(key));
 }
 
 void CTinyJS::native_Object_getOwnPropertyDescriptor(const CFunctionsScopePtr &c, void *data) {
@@ -6360,13 +8596,12 @@ void CTinyJS::native_Object_defineProperties(const CFunctionsScopePtr &c, void *
 
 	CScriptVarPtr properties = c->getArgument(1);
 
-	STRING_SET_t names;
-	properties->keys(names, true);
-
-	for(STRING_SET_it it=names.begin(); it!=names.end(); ++it) {
-		CScriptVarPtr attributes = properties->findChildWithStringChars(*it).getter();
-		if(!attributes->isObject()) c->throwError(TypeError, "descriptor for "+*it+" is not an object");
-		const char *err = obj->defineProperty(*it, attributes);
+	CScriptKeysIterator names(properties);
+	string name;
+	while(names.next(name)) {
+		CScriptVarPtr attributes = properties->findChildWithStringChars(name).getter();
+		if(!attributes->isObject()) c->throwError(TypeError, "descriptor for "+name+" is not an object");
+		const char *err = obj->defineProperty(name, attributes);
 		if(err) c->throwError(TypeError, err);
 	}
 }
@@ -6507,6 +8742,127 @@ void CTinyJS::native_Iterator(const CFunctionsScopePtr &c, void *data) {
 	c->setReturnVar(c->getArgument(0)->toIterator(c->getArgument(1)->toBoolean()?1:3));
 }
 
+////////////////////////////////////////////////////////////////////////// 
+/// Map, Set, WeakMap, WeakSet
+//////////////////////////////////////////////////////////////////////////
+
+static const char *mapKindNames[] = { "Map", "Set", "WeakMap", "WeakSet" };
+
+static CScriptVarMapPtr getMapThis(const CFunctionsScopePtr &c, int Kind, const char *Fnc) {
+	CScriptVarMapPtr Map(c->getArgument("this"));
+	if(!Map || Map->getKind() != Kind)
+		c->throwError(TypeError, string(mapKindNames[Kind])+".prototype."+Fnc+" method called on incompatible Object");
+	return Map;
+}
+
+static void addToMap(const CFunctionsScopePtr &c, const CScriptVarMapPtr &Map, const CScriptVarPtr &Item) {
+	CScriptVarPtr key = Item, value = Item;
+	if(!(Map->getKind() & CScriptVarMap::SET)) {
+		if(Item->isPrimitive()) c->throwError(TypeError, "iterator value "+Item->toString()+" is not an entry object");
+		key = Item->findChildWithStringChars("0");
+		value = Item->findChildWithStringChars("1");
+		if(!key) key = c->constScriptVar(Undefined);
+		if(!value) value = c->constScriptVar(Undefined);
+	}
+	if((Map->getKind() & CScriptVarMap::WEAK) && key->isPrimitive())
+		c->throwError(TypeError, "invalid "+string(mapKindNames[Map->getKind()])+" key");
+	Map->set(key, value);
+}
+
+void CTinyJS::native_Map(const CFunctionsScopePtr &c, void *data) {
+	int kind = (int)(size_t)data;
+	CScriptVarMapPtr Map = ::newScriptVarMap(this, kind);
+	c->setReturnVar(Map);
+	CScriptVarPtr iterable = c->getArgument(0);
+	if(iterable->isUndefined() || iterable->isNull()) return;
+
+	CScriptVarMapPtr Source(iterable);
+	if(Source && !(Source->getKind() & CScriptVarMap::WEAK)) {
+		CScriptVarMap::CIteratorLock lock(Source);
+		uint32_t cursor = 0;
+		CScriptVarPtr key, value;
+		while(Source->getEntry(cursor, key, value)) {
+			if(Source->getKind() & CScriptVarMap::SET)
+				addToMap(c, Map, value);
+			else if(kind & CScriptVarMap::SET) { // the items of a Map are [key, value] pairs
+				CScriptVarPtr entry = newScriptVar(Array);
+				entry->setArrayIndex(0, key);
+				entry->setArrayIndex(1, value);
+				addToMap(c, Map, entry);
+			} else {
+				if((kind & CScriptVarMap::WEAK) && key->isPrimitive())
+					c->throwError(TypeError, "invalid "+string(mapKindNames[kind])+" key");
+				Map->set(key, value);
+			}
+		}
+		return;
+	}
+	if(iterable->isArray()) {
+		uint32_t length = iterable->getArrayLength();
+		for(uint32_t i=0; i<length; ++i)
+			addToMap(c, Map, iterable->getArrayIndex(i));
+		return;
+	}
+	CScriptVarPtr Iterator = iterable->toIterator(2);
+	CScriptVarFunctionPtr Next(Iterator->findChildWithPrototypeChain("next").getter());
+	if(!Next) c->throwError(TypeError, iterable->toString()+" is not iterable");
+	vector<CScriptVarPtr> args;
+	for(;;) {
+		CScriptResult execute;
+		CScriptVarPtr Item = callFunction(execute, Next, args, Iterator);
+		if(execute.isThrow()) {
+			if(execute.value == constStopIteration) break;
+			execute.cThrow();
+		}
+		addToMap(c, Map, Item);
+	}
+}
+void CTinyJS::native_Map_prototype_get(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarPtr value = getMapThis(c, (int)(size_t)data, "get")->get(c->getArgument(0));
+	if(value) c->setReturnVar(value);
+}
+void CTinyJS::native_Map_prototype_set(const CFunctionsScopePtr &c, void *data) {
+	int kind = (int)(size_t)data;
+	CScriptVarMapPtr Map = getMapThis(c, kind, kind & CScriptVarMap::SET ? "add" : "set");
+	CScriptVarPtr key = c->getArgument(0);
+	if((kind & CScriptVarMap::WEAK) && key->isPrimitive())
+		c->throwError(TypeError, "invalid "+string(mapKindNames[kind])+" key");
+	Map->set(key, kind & CScriptVarMap::SET ? key : c->getArgument(1));
+	c->setReturnVar(Map);
+}
+void CTinyJS::native_Map_prototype_has(const CFunctionsScopePtr &c, void *data) {
+	c->setReturnVar(constScriptVar(getMapThis(c, (int)(size_t)data, "has")->has(c->getArgument(0))));
+}
+void CTinyJS::native_Map_prototype_delete(const CFunctionsScopePtr &c, void *data) {
+	c->setReturnVar(constScriptVar(getMapThis(c, (int)(size_t)data, "delete")->remove(c->getArgument(0))));
+}
+void CTinyJS::native_Map_prototype_clear(const CFunctionsScopePtr &c, void *data) {
+	getMapThis(c, (int)(size_t)data, "clear")->clear();
+}
+void CTinyJS::native_Map_prototype_size(const CFunctionsScopePtr &c, void *data) {
+	c->setReturnVar(c->newScriptVar(getMapThis(c, (int)(size_t)data, "size")->size()));
+}
+void CTinyJS::native_Map_prototype_forEach(const CFunctionsScopePtr &c, void *data) {
+	CScriptVarMapPtr Map = getMapThis(c, (int)(size_t)data, "forEach");
+	CScriptVarFunctionPtr callback(c->getArgument(0));
+	if(!callback) c->throwError(TypeError, "forEach: argument 0 is not a function");
+	CScriptVarPtr thisArg = c->getArgument(1);
+	CScriptVarMap::CIteratorLock lock(Map);
+	vector<CScriptVarPtr> args(3);
+	args[2] = Map;
+	uint32_t cursor = 0;
+	while(Map->getEntry(cursor, args[1], args[0]))
+		callFunction(callback, args, thisArg);
+}
+void CTinyJS::native_Map_prototype_iterator(const CFunctionsScopePtr &c, void *data) {
+	int kind = (int)(size_t)data & 3, mode = (int)(size_t)data >> 2;
+	static const char *fnc[] = { "__iterator__", "keys", "values", "entries" };
+	CScriptVarMapPtr Map = getMapThis(c, kind, fnc[mode]);
+	if(mode == 0) // __iterator__(keysOnly) -> for(k in map) iterates the keys, for each(e in map) the entries
+		mode = c->getArgument(0)->toBoolean() ? 1 : (kind & CScriptVarMap::SET ? 2 : 3);
+	c->setReturnVar(::newScriptVarMapIterator(this, Map, mode));
+}
+
 ////////////////////////////////////////////////////////////////////////// 
 /// Generator
 //////////////////////////////////////////////////////////////////////////
@@ -6622,10 +8978,24 @@ void CTinyJS::native_eval(const CFunctionsScopePtr &c, void *data) {
 	string Code = c->getArgument("jsCode")->toString();
 	CScriptVarScopePtr scEvalScope = scopes.back(); // save scope
 	scopes.pop_back(); // go back to the callers scope
+	CScriptVarPtr value;
+	try {
+		value = executeScript(CScript(), Code, "eval");
+	} catch (...) {
+		scopes.push_back(scEvalScope); // restore Scopes;
+		throw; // re-throw
+	}
+	scopes.push_back(scEvalScope); // restore Scopes;
+	if(value)
+		c->setReturnVar(value);
+}
+
+// eval and require - executes the statements of Script (or else of Code) in the current scope
+CScriptVarPtr CTinyJS::executeScript(const CScript &Script, const string &Code, const string &File) {
 	CScriptResult execute;
 	CScriptTokenizer *oldTokenizer = t; t=0;
 	try {
-		CScriptTokenizer Tokenizer(Code.c_str(), "eval");
+		CScriptTokenizer Tokenizer(Script.isCompiled() ? Script : compileEval(Code, File));
 		t = &Tokenizer;
 		do {
 			execute_statement(execute);
@@ -6633,22 +9003,23 @@ void CTinyJS::native_eval(const CFunctionsScopePtr &c, void *data) {
 		} while (t->tk!=LEX_EOF);
 	} catch (CScriptException *e) { // script exceptions
 		t = oldTokenizer; // restore tokenizer
-		scopes.push_back(scEvalScope); // restore Scopes;
-		if(haveTry) { // an Error in eval is always catchable
-			CScriptVarPtr E = newScriptVarError(this, e->errorType, e->message.c_str(), e->fileName.c_str(), e->lineNumber, e->column);
-			delete e;
-			throw E;
-		} else
-			throw e;
+		throwCatchable(e);
 	} catch (...) { // all other exceptions
 		t = oldTokenizer; // restore tokenizer
-		scopes.push_back(scEvalScope); // restore Scopes;
 		throw; // re-throw
 	}
 	t = oldTokenizer; // restore tokenizer
-	scopes.push_back(scEvalScope); // restore Scopes;
-	if(execute.value)
-		c->setReturnVar(execute.value);
+	return execute.value;
+}
+
+// an Error in eval or require is always catchable
+void CTinyJS::throwCatchable(CScriptException *e) {
+	if(haveTry) {
+		CScriptVarPtr E = newScriptVarError(this, e->errorType, e->message.c_str(), e->fileName.c_str(), e->lineNumber, e->column);
+		delete e;
+		throw E;
+	}
+	throw e;
 }
 
 static int _native_require_read(const string &Fname, std::string &Data) {
@@ -6664,20 +9035,246 @@ static int _native_require_read(const string &Fname, std::string &Data) {
 	return errno;
 }
 
-void CTinyJS::native_require(const CFunctionsScopePtr &c, void *data) {
-	string File = c->getArgument("jsFile")->toString();
+//////////////////////////////////////////////////////////////////////////
+/// CScriptSource
+//////////////////////////////////////////////////////////////////////////
+
+class CScriptSourceString : public CScriptSource {
+public:
+	CScriptSourceString(string &Code) { code.swap(Code); Data = code.c_str(); Size = code.size(); }
+private:
+	string code;
+};
+
+#ifndef _WIN32
+class CScriptSourceMapped : public CScriptSource {
+public:
+	CScriptSourceMapped(void *Mapping, size_t MappingSize) : mapping(Mapping), mappingSize(MappingSize) { Data = (const char*)mapping; Size = mappingSize; }
+	~CScriptSourceMapped() { munmap(mapping, mappingSize); }
+	virtual bool isMapped() const { return true; }
+private:
+	void *mapping;
+	size_t mappingSize;
+};
+#endif
+
+CScriptSource *CScriptSource::fromString(string &Code) {
+	return new CScriptSourceString(Code);
+}
+
+CScriptTokenDataSource::CScriptTokenDataSource(CScriptSource *Source) : code(Source->data()), size(Source->size()), mapping(Source) {}
+CScriptTokenDataSource::~CScriptTokenDataSource() { delete mapping; }
+bool CScriptTokenDataSource::isMapped() const { return mapping && mapping->isMapped(); }
+
+CScriptSource *CScriptSource::open(const string &File, int &ErrorNo) {
+#ifndef _WIN32
+	int fd = ::open(File.c_str(), O_RDONLY);
+	if(fd < 0) {
+		ErrorNo = errno;
+		return 0;
+	}
+	struct stat st;
+	void *mapping = MAP_FAILED;
+	size_t size = 0;
+	// the zero-filled rest of the last page terminates the source -> a file of whole pages is read
+	if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && (size = (size_t)st.st_size) % sysconf(_SC_PAGESIZE))
+		mapping = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(mapping != MAP_FAILED) return new CScriptSourceMapped(mapping, size);
+#endif
 	string Code;
-	int ErrorNo;
-	if(!native_require_read) 
-		native_require_read = _native_require_read; // use builtin if no callback
+	if((ErrorNo = _native_require_read(File, Code)) != 0) return 0;
+	return new CScriptSourceString(Code);
+}
 
-	if((ErrorNo = native_require_read(File, Code))) {
+// the builtin reader maps the files - also if the returned old read-function is set again
+bool CTinyJS::isBuiltinRequireReader() {
+	return (!native_require_read || native_require_read == _native_require_read) && (!native_require_source || native_require_source == CScriptSource::open);
+}
+
+// the resolved path of a file of the builtin reader - the key of the module registry
+static string resolveRequirePath(const string &File) {
+#ifdef _WIN32
+	char Path[_MAX_PATH];
+	if(_fullpath(Path, File.c_str(), _MAX_PATH)) return Path;
+#else
+	if(char *Path = realpath(File.c_str(), 0)) {
+		string Resolved(Path);
+		free(Path);
+		return Resolved;
+	}
+#endif
+	return File;
+}
+
+// a CommonJS module uses a free exports or module.exports - not a property like o.exports or { exports: 1 }
+// and not a name declared by the script (var exports = {}) - the lexer sees no scopes, so a declaration anywhere counts
+static bool isCommonJSModule(const char *Code) {
+	CScriptLex Lexer(Code);
+	int prev = 0, prev2 = 0; // the tokens before the current
+	bool prevIsModule = false; // prev is a free "module"
+	bool usesExports = false, usesModuleExports = false, declaresExports = false, declaresModule = false;
+	int depth = 0, varDepth = -1, paramsDepth = -1; // the nesting of the open var-list and of the open parameter-list
+	bool beforeParams = false; // after function or catch
+	while(Lexer.tk != LEX_EOF) {
+		int tk = Lexer.tk;
+		bool isModule = false;
+		if(tk == LEX_ID) {
+			bool declared = prev == LEX_R_VAR || prev == LEX_R_LET || prev == LEX_R_CONST || prev == LEX_R_FUNCTION
+				|| (prev == ',' && depth == varDepth) || ((prev == '(' || prev == ',') && depth == paramsDepth);
+			if(Lexer.tkStr == "exports") {
+				if(declared)
+					declaresExports = true;
+				else if(prev == '.')
+					usesModuleExports = usesModuleExports || (prev2 == LEX_ID && prevIsModule);
+				else {
+					Lexer.match(LEX_ID);
+					if(Lexer.tk != ':' || (prev != '{' && prev != ',')) usesExports = true; // not a key of an object literal
+					prev2 = prev, prev = LEX_ID;
+					continue;
+				}
+			} else if(Lexer.tkStr == "module") {
+				if(declared) declaresModule = true;
+				else isModule = prev != '.';
+			}
+		}
+		switch(tk) {
+		case LEX_R_VAR: case LEX_R_LET: case LEX_R_CONST: varDepth = depth; break;
+		case LEX_R_FUNCTION: case LEX_R_CATCH: beforeParams = true; break;
+		case ';': if(depth == varDepth) varDepth = -1; break;
+		case '(': case '[': case '{':
+			if(tk == '(' && beforeParams) paramsDepth = depth+1;
+			beforeParams = false;
+			depth++;
+			break;
+		case ')': case ']': case '}':
+			if(depth == paramsDepth) paramsDepth = -1;
+			if(--depth < varDepth) varDepth = -1;
+			break;
+		}
+		if(tk != '.') prevIsModule = isModule; // "module" stays remembered over the '.'
+		prev2 = prev, prev = tk;
+		Lexer.match(tk);
+	}
+	return (usesExports && !declaresExports) || (usesModuleExports && !declaresModule);
+}
+
+// reads and compiles a new or changed module - returns true if the module has changed
+bool CTinyJS::updateModule(MODULE &Module, const string &Path) {
+	bool builtin = isBuiltinRequireReader();
+	int64_t mtime = 0, size = -1;
+	if(builtin) {
+		struct stat st;
+		if(stat(Path.c_str(), &st) == 0) mtime = st.st_mtime, size = st.st_size;
+		if(Module.script.isCompiled() && mtime == Module.mtime && size == Module.size && mtime < Module.readTime) return false;
+	}
+	CScriptSource *Source = 0;
+	int ErrorNo = 0;
+	if(builtin)
+		Source = CScriptSource::open(Path, ErrorNo);
+	else if(native_require_read) {
+		string Code;
+		if((ErrorNo = native_require_read(Module.file, Code)) == 0) Source = CScriptSource::fromString(Code);
+	} else
+		Source = native_require_source(Module.file, ErrorNo);
+	if(!Source) {
 		ostringstream msg;
-		msg << "can't read \"" << File << "\" (Error=" << ErrorNo << ")";
-		c->throwError(Error, msg.str());
+		msg << "can't read \"" << Module.file << "\" (Error=" << ErrorNo << ")";
+		throw newScriptVarError(this, Error, msg.str().c_str());
+	}
+	Module.mtime = mtime;
+	Module.size = size;
+	Module.readTime = time(0);
+	uint64_t hash = CScript::hashSource(Source->data(), Source->size());
+	if(Module.script.isCompiled() && hash == Module.hash) {
+		delete Source;
+		return false;
+	}
+	Module.hash = hash;
+	Module.commonJS = isCommonJSModule(Source->data());
+	if(Module.commonJS) { // the module is the function(module, exports) - the prefix keeps the line numbers
+		string Code = "(function(module, exports) {" + string(Source->data(), Source->size()) + "\n})";
+		delete Source;
+		Source = CScriptSource::fromString(Code);
+	}
+	// the script owns the source - the tokenizer reads directly from it, the functions reference it (or a copy of a mapped file)
+	Module.script = codeCache && builtin ? compileCached(Source, Module.file, Path + ".tjsc") : CScript(Source, Module.file);
+	Module.exports = CScriptVarPtr();
+	Module.dependencies.clear();
+	return true;
+}
+
+// the cached exports are out of date if a module required by the module (or by those) has changed
+bool CTinyJS::dependenciesChanged(MODULE &Module) {
+	Module.visit = moduleVisit;
+	for(STRING_SET_it it=Module.dependencies.begin(); it!=Module.dependencies.end(); ++it) {
+		MODULES_it dependency = modules.find(*it);
+		if(dependency == modules.end()) return true;
+		if(dependency->second.visit == moduleVisit) continue; // already checked (or a cycle)
+		if(updateModule(dependency->second, *it) || dependenciesChanged(dependency->second)) return true;
+	}
+	return false;
+}
+
+void CTinyJS::native_require(const CFunctionsScopePtr &c, void *data) {
+	string File = c->getArgument("jsFile")->toString();
+	string Path = isBuiltinRequireReader() ? resolveRequirePath(File) : File;
+	if(moduleStack.size()) // the dependency graph
+		modules[moduleStack.back()].dependencies.insert(Path);
+	MODULE &Module = modules[Path];
+	if(Module.loading) { // a cyclic require
+		if(Module.exports) c->setReturnVar(Module.exports);
+		return;
 	}
-	c->addChildOrReplace("jsCode", c->newScriptVar(Code));
-	native_eval(c, data);
+	Module.file = File;
+	try {
+		bool changed = updateModule(Module, Path);
+		++moduleVisit;
+		if(Module.commonJS && Module.exports && !changed && !dependenciesChanged(Module)) {
+			c->setReturnVar(Module.exports);
+			return;
+		}
+	} catch (CScriptException *e) {
+		modules.erase(Path);
+		throwCatchable(e);
+	} catch (...) {
+		modules.erase(Path);
+		throw;
+	}
+
+	CScriptVarScopePtr scRequireScope = scopes.back(); // save scope
+	scopes.pop_back(); // go back to the callers scope
+	if(Module.commonJS) scopes.push_back(root); // a CommonJS module is a function in the global scope
+	moduleStack.push_back(Path);
+	Module.loading = true;
+	CScriptVarPtr value;
+	try {
+		value = executeScript(Module.script);
+		if(Module.commonJS) {
+			CScriptVarPtr module = newScriptVar(Object);
+			Module.exports = newScriptVar(Object);
+			module->addChild("exports", Module.exports);
+			module->addChild("id", newScriptVar(Path));
+			vector<CScriptVarPtr> arguments;
+			arguments.push_back(module);
+			arguments.push_back(Module.exports);
+			callFunction(value, arguments, Module.exports);
+			value = Module.exports = module->findChild("exports");
+		}
+	} catch (...) {
+		Module.loading = false;
+		Module.exports = CScriptVarPtr();
+		moduleStack.pop_back();
+		if(Module.commonJS) scopes.pop_back();
+		scopes.push_back(scRequireScope); // restore Scopes;
+		throw; // re-throw
+	}
+	Module.loading = false;
+	moduleStack.pop_back();
+	if(Module.commonJS) scopes.pop_back();
+	scopes.push_back(scRequireScope); // restore Scopes;
+	if(value)
+		c->setReturnVar(value);
 }
 
 void CTinyJS::native_isNAN(const CFunctionsScopePtr &c, void *data) {
@@ -6728,10 +9325,16 @@ void CTinyJS::setTemporaryID_recursive(uint32_t ID) {
 		if(**it) (**it)->setTemporaryMark_recursive(ID);
 	for(int i=Error; i<ERROR_COUNT; i++)
 		if(errorPrototypes[i]) errorPrototypes[i]->setTemporaryMark_recursive(ID);
+	for(MODULES_it it=modules.begin(); it!=modules.end(); ++it)
+		if(it->second.exports) it->second.exports->setTemporaryMark_recursive(ID);
+	for(int i=0; i<LITERAL_CACHE_SIZE; ++i)
+		if(literalCache[i].var) literalCache[i].var->setTemporaryMark_recursive(ID);
 	root->setTemporaryMark_recursive(ID);
 }
 
 void CTinyJS::ClearUnreferedVars(const CScriptVarPtr &extra/*=CScriptVarPtr()*/) {
+	clearCallSiteCache(); // the cache must not keep garbage alive
+	letScopePool.clear(); // the pool is not reachable from the root
 	uint32_t UniqueID = allocUniqueID(); 
 	setTemporaryID_recursive(UniqueID);
 	if(extra) extra->setTemporaryMark_recursive(UniqueID);
@@ -42,6 +42,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <list>
 #include <set>
 #include <stdint.h>
 #include <string.h>
@@ -49,6 +50,15 @@
 #include <limits>
 
 #include "config.h"
+#ifdef HAVE_CXX_THREADS
+#	include <atomic>
+#endif
+#ifdef HAVE_CXX11_VARIADIC_TEMPLATES
+#	include <type_traits>
+#	if __cplusplus >= 201703L
+#		include <string_view>
+#	endif
+#endif
 
 #ifdef NO_POOL_ALLOCATOR
 	template<typename T, int num_objects=64>
@@ -99,7 +109,6 @@ enum LEX_TYPES {
 	LEX_MINUSMINUS,
 	LEX_ANDAND,
 	LEX_OROR,
-	LEX_INT,
 
 #define LEX_ASSIGNMENTS_BEGIN LEX_PLUSEQUAL
 	LEX_PLUSEQUAL,
@@ -124,7 +133,10 @@ enum LEX_TYPES {
 	LEX_T_DUMMY_LABEL,
 #define LEX_TOKEN_STRING_END LEX_T_DUMMY_LABEL
 
+#define LEX_TOKEN_NUMBER_BEGIN LEX_INT
+	LEX_INT,
 	LEX_FLOAT,
+#define LEX_TOKEN_NUMBER_END LEX_FLOAT
 #define LEX_TOKEN_NONSIMPLE_1_END LEX_FLOAT
 
 	// reserved words
@@ -176,7 +188,8 @@ enum LEX_TYPES {
 	LEX_T_OBJECT_LITERAL,
 	LEX_T_DESTRUCTURING_VAR,
 	LEX_T_FORWARD,
-#define LEX_TOKEN_NONSIMPLE_2_END LEX_T_FORWARD
+	LEX_T_SWITCH_TABLE,
+#define LEX_TOKEN_NONSIMPLE_2_END LEX_T_SWITCH_TABLE
 
 	LEX_T_EXCEPTION_VAR,
 	LEX_T_SKIP,
@@ -185,13 +198,16 @@ enum LEX_TYPES {
 
 };
 #define LEX_TOKEN_DATA_STRING(tk) ((LEX_TOKEN_STRING_BEGIN<= tk && tk <= LEX_TOKEN_STRING_END))
+#define LEX_TOKEN_DATA_NUMBER(tk) (LEX_TOKEN_NUMBER_BEGIN <= tk && tk <= LEX_TOKEN_NUMBER_END)
 #define LEX_TOKEN_DATA_FLOAT(tk) (tk==LEX_FLOAT)
+#define LEX_TOKEN_DATA_LITERAL(tk) (LEX_TOKEN_DATA_NUMBER(tk) || tk==LEX_STR)
 #define LEX_TOKEN_DATA_LOOP(tk) (LEX_TOKEN_FOR_BEGIN <= tk && tk <= LEX_TOKEN_FOR_END)
 #define LEX_TOKEN_DATA_FUNCTION(tk) (LEX_TOKEN_FUNCTION_BEGIN <= tk && tk <= LEX_TOKEN_FUNCTION_END)
 #define LEX_TOKEN_DATA_TRY(tk) (tk == LEX_T_TRY)
 #define LEX_TOKEN_DATA_OBJECT_LITERAL(tk) (tk==LEX_T_OBJECT_LITERAL)
 #define LEX_TOKEN_DATA_DESTRUCTURING_VAR(tk) (tk==LEX_T_DESTRUCTURING_VAR)
 #define LEX_TOKEN_DATA_FORWARDER(tk) (tk==LEX_T_FORWARD)
+#define LEX_TOKEN_DATA_SWITCH_TABLE(tk) (tk==LEX_T_SWITCH_TABLE)
 
 #define LEX_TOKEN_DATA_SIMPLE(tk) (!((LEX_TOKEN_NONSIMPLE_1_BEGIN <= tk && tk <= LEX_TOKEN_NONSIMPLE_1_END) || (LEX_TOKEN_NONSIMPLE_2_BEGIN <= tk && tk <= LEX_TOKEN_NONSIMPLE_2_END)))
 
@@ -279,10 +295,12 @@ public:
 /// CScriptLex
 //////////////////////////////////////////////////////////////////////////
 
+class CScriptTokenDataString;
 class CScriptLex
 {
 public:
 	CScriptLex(const char *Code, const std::string &File="", int Line=0, int Column=0);
+	~CScriptLex();
 	struct POS;
 	int tk; ///< The type of the token that we have
 	int last_tk; ///< The type of the last token that we have
@@ -302,13 +320,22 @@ public:
 	int currentLine() { return pos.currentLine; }
 	int currentColumn() { return pos.currentColumn(); }
 	bool lineBreakBeforeToken;
+	const char *tokenEnd; ///< the end of the last matched token
+	const char *getCode() { return data; }
+	CScriptTokenDataString *tkAtom(); ///< the token-data of tkStr - all tokens with the same string share one token-data
 private:
+	CScriptLex(const CScriptLex &noCopy);
+	CScriptLex &operator=(const CScriptLex &noCopy);
+	std::map<std::string, CScriptTokenDataString*> atoms;
 	const char *data;
 	const char *dataPos;
 	char currCh, nextCh;
 
 	void getNextCh();
 	void getNextToken(); ///< Get the text token from our text string
+	const char *currentPos() { return dataPos - (nextCh == LEX_EOF ? (currCh == LEX_EOF ? 0 : 1) : 2); } ///< the position of currCh
+	void setPos(const char *Pos); ///< continue at Pos - the scanned characters must not contain line breaks
+	const char *skipNewLine(const char *Pos);
 };
 
 
@@ -332,7 +359,11 @@ public:
 	void ref() { refs++; }
 	void unref() { if(--refs == 0) delete this; }
 private:
+#ifdef HAVE_CXX_THREADS
+	std::atomic<int> refs; ///< the tokens of a CScript are shared by contexts in different threads
+#else
 	int refs;
+#endif
 };
 template<typename C>
 class CScriptTokenDataPtr {
@@ -356,16 +387,55 @@ private:
 	C *ptr;
 };
 
-class CScriptTokenDataString : public fixed_size_object<CScriptTokenDataString>, public CScriptTokenData {
+class CScriptVar;
+class CScriptTokenDataLiteral : public CScriptTokenData {
+protected:
+	CScriptTokenDataLiteral();
+public:
+	/// token-data outlives contexts and is shared by them -> the Var of a literal is cached by the context under this number (see CTinyJS::literalScriptVar)
+	uint32_t getSerial() { return serial; }
+private:
+	uint32_t serial; ///< unique number of the literal - never 0
+};
+
+class CScriptTokenDataString : public fixed_size_object<CScriptTokenDataString>, public CScriptTokenDataLiteral {
 public:
 	CScriptTokenDataString(const std::string &String) : tokenStr(String) {}
 	std::string tokenStr;
 private:
 };
 
+class CScriptTokenDataNumber : public fixed_size_object<CScriptTokenDataNumber>, public CScriptTokenDataLiteral {
+public:
+	CScriptTokenDataNumber(int Int) : intData(Int) {}
+	CScriptTokenDataNumber(double Float) : floatData(Float) {}
+	union {
+		int		intData;		///< LEX_INT
+		double	floatData;	///< LEX_FLOAT
+	};
+};
+
+class CScriptSource;
+/// the source of a script with functions - kept alive by its functions (for toString and the lazy bodies)
+/// a copy of a temporary code or a mapped file, or the CScriptSource of the script (no copy)
+class CScriptTokenDataSource : public CScriptTokenData {
+public:
+	CScriptTokenDataSource(const char *Code) : copy(Code), mapping(0) { code = copy.c_str(); size = copy.size(); }
+	CScriptTokenDataSource(const char *Code, size_t Size) : copy(Code, Size), mapping(0) { code = copy.c_str(); size = copy.size(); }
+	CScriptTokenDataSource(CScriptSource *Source); ///< takes the ownership of Source
+	~CScriptTokenDataSource();
+	bool isMapped() const; ///< the code is a mapped file (see CScriptSource::isMapped)
+	const char *code; ///< nul-terminated
+	size_t size;
+private:
+	std::string copy;
+	CScriptSource *mapping;
+};
+
 class CScriptTokenDataFnc : public fixed_size_object<CScriptTokenDataFnc>, public CScriptTokenData {
 public:
-	CScriptTokenDataFnc() : line(0),isGenerator(false), isArrowFunction(false) {}
+	CScriptTokenDataFnc() : line(0),isGenerator(false), isArrowFunction(false), sourceBegin(0), sourceEnd(0), capture(CAPTURE_UNKNOWN), parameters(PARAMETERS_UNKNOWN), lazy(0) {}
+	~CScriptTokenDataFnc();
 	std::string file;
 	int line;
 	std::string name;
@@ -374,11 +444,47 @@ public:
 	std::string getArgumentsString(bool forArrowFunction=false);
 	bool isGenerator;
 	bool isArrowFunction;
+
+	/// the text of the function in its source - toString copies it instead of printing the tokens
+	CScriptTokenDataPtr<CScriptTokenDataSource> source;
+	size_t sourceBegin, sourceEnd; ///< sourceEnd == 0 -> no text (accessors are printed from the tokens)
+	bool hasSourceString() { return sourceEnd != 0; }
+	std::string getSourceString() { return std::string(source->code+sourceBegin, sourceEnd-sourceBegin); }
+
+	/// closure capture - the free names of the function (analyzed on first creation of a function object)
+	enum { CAPTURE_UNKNOWN, CAPTURE_NAMES, CAPTURE_SCOPE } capture; ///< CAPTURE_SCOPE = eval is used -> the whole scope chain is needed
+	STRING_VECTOR_t captureNames; ///< sorted
+	void analyzeCapture();
+
+	/// simple parameters (no default values, no destructuring, no generator) are assigned directly into the function scope
+	enum { PARAMETERS_UNKNOWN, PARAMETERS_SIMPLE, PARAMETERS_COMPLEX } parameters;
+	STRING_VECTOR_t paramNames; ///< the names of simple parameters
+	bool hasSimpleParameters() { if(parameters == PARAMETERS_UNKNOWN) analyzeParameters(); return parameters == PARAMETERS_SIMPLE; }
+	void analyzeParameters();
+
+	/// lazy body - only the extent of the body is known until the first call (see CScriptTokenizer::lazyFunctions)
+	struct LAZY_BODY {
+		size_t begin;		///< the offset of the '{' in source
+		size_t lineStart;	///< the offset of the line of the '{'
+		int line;
+		bool shared;		///< part of a CScript -> the body needs prepareSharedTokens
+	};
+	LAZY_BODY *getLazyBody() { return lazy; }
+	bool isLazy() { return getLazyBody() != 0; }
+	void tokenizeBody() { if(isLazy()) tokenizeLazyBody(); } ///< throws a CScriptException on syntax errors in the body
+private:
+	void tokenizeLazyBody();
+#ifdef HAVE_CXX_THREADS
+	std::atomic<LAZY_BODY*> lazy; ///< the body of a shared CScript is tokenized by the first calling thread
+#else
+	LAZY_BODY *lazy;
+#endif
+	friend class CScriptTokenizer;
 };
 
 class CScriptTokenDataForwards : public fixed_size_object<CScriptTokenDataForwards>, public CScriptTokenData {
 public:
-	CScriptTokenDataForwards() {}
+	CScriptTokenDataForwards() : scopeTemplateReady(false) {}
 	enum { 
 		LETS = 0,
 		VARS,
@@ -400,6 +506,19 @@ public:
 	std::string addVarsInLetscope(STRING_VECTOR_t &Vars);
 	std::string addLets(STRING_VECTOR_t &Lets);
 	bool empty() { return varNames[LETS].empty() && varNames[VARS].empty() && varNames[CONSTS].empty() && functions.empty(); }
+
+	/// scope template - the forwarded names presorted like the Childs of a Var (built on first execution)
+	struct SLOT {
+		std::string name;
+		int flags;
+		const CScriptToken *fnc; ///< the hoisted function or 0 for undefined
+	};
+	typedef std::vector<SLOT> SLOTS_t;
+	typedef SLOTS_t::iterator SLOTS_it;
+	SLOTS_t letSlots;
+	SLOTS_t varSlots; ///< vars, consts and functions
+	bool scopeTemplateReady;
+	void buildScopeTemplate();
 private:
 };
 class CScriptTokenDataForwardsPtr {
@@ -450,6 +569,7 @@ private:
 
 class CScriptTokenDataObjectLiteral : public fixed_size_object<CScriptTokenDataObjectLiteral>, public CScriptTokenData {
 public:
+	CScriptTokenDataObjectLiteral() : flags(0), boilerplateState(BOILERPLATE_NONE) {}
 	enum {ARRAY, OBJECT} type;
 	int flags;
 	struct ELEMENT {
@@ -462,6 +582,17 @@ public:
 	void setMode(bool Destructuring);
 	std::string getParsableString();
 	bool toDestructuringVar(CScriptTokenDataDestructuringVar &DestructuringVar);
+
+	/// the boilerplate is the layout of the created object: the names sorted like the Childs 
+	/// with the element that gives the value (the last one of duplicated names) and the token of constant values
+	struct SLOT {
+		std::string name;
+		int element;
+		int constToken; ///< LEX_INT, LEX_FLOAT, LEX_STR, LEX_R_TRUE, LEX_R_FALSE, LEX_R_NULL or 0
+	};
+	enum { BOILERPLATE_NONE, BOILERPLATE_READY, BOILERPLATE_UNUSABLE } boilerplateState;
+	std::vector<SLOT> boilerplate;
+	void buildBoilerplate(); ///< literals with getters or setters are UNUSABLE
 private:
 };
 
@@ -479,20 +610,34 @@ public:
 	std::string getParsableString(const std::string &IndentString="", const std::string &Indent="");
 };
 
+/// the jump table of a switch with only number- and string-literals as case labels
+/// the offsets are relative to the LEX_T_SWITCH_TABLE-token behind the '{' and point to the ':' of a case
+class CScriptTokenDataSwitchTable : public fixed_size_object<CScriptTokenDataSwitchTable>, public CScriptTokenData {
+public:
+	CScriptTokenDataSwitchTable() : defaultCase(0) {}
+	typedef std::map<double, int> NUMBER_CASES_t;
+	typedef std::map<std::string, int> STRING_CASES_t;
+	NUMBER_CASES_t numberCases; ///< -0 and 0 are the same key (as for ===)
+	STRING_CASES_t stringCases;
+	int defaultCase; ///< the ':' of default or the '}' of the switch-block
+};
+
 
 //////////////////////////////////////////////////////////////////////////
 /// CScriptToken
 //////////////////////////////////////////////////////////////////////////
 
 class CScriptTokenizer;
+class CScript;
+class CScriptTokenDataScript;
 /*
 	a Token needs 8 Byte
 	2 Bytes for the Row-Position of the Token
 	2 Bytes for the Token self
 	and
 	4 Bytes for special Datas in an union
-			e.g. an int for interger-literals 
-			or pointer for double-literals,
+			e.g. an int for skip-offsets
+			or pointer for number-literals,
 			for string-literals or for functions
 */
 class CScriptToken : public fixed_size_object<CScriptToken>
@@ -507,15 +652,19 @@ public:
 	~CScriptToken() { clear(); }
 
 	int &Int() { ASSERT(LEX_TOKEN_DATA_SIMPLE(token)); return intData; }
-	std::string &String() { ASSERT(LEX_TOKEN_DATA_STRING(token)); return dynamic_cast<CScriptTokenDataString*>(tokenData)->tokenStr; }
-	double &Float() { ASSERT(LEX_TOKEN_DATA_FLOAT(token)); return *floatData; }
-	CScriptTokenDataFnc &Fnc() { ASSERT(LEX_TOKEN_DATA_FUNCTION(token)); return *dynamic_cast<CScriptTokenDataFnc*>(tokenData); }
-	const CScriptTokenDataFnc &Fnc() const { ASSERT(LEX_TOKEN_DATA_FUNCTION(token)); return *dynamic_cast<CScriptTokenDataFnc*>(tokenData); }
-	CScriptTokenDataObjectLiteral &Object() { ASSERT(LEX_TOKEN_DATA_OBJECT_LITERAL(token)); return *dynamic_cast<CScriptTokenDataObjectLiteral*>(tokenData); }
-	CScriptTokenDataDestructuringVar &DestructuringVar() { ASSERT(LEX_TOKEN_DATA_DESTRUCTURING_VAR(token)); return *dynamic_cast<CScriptTokenDataDestructuringVar*>(tokenData); }
-	CScriptTokenDataLoop &Loop() { ASSERT(LEX_TOKEN_DATA_LOOP(token)); return *dynamic_cast<CScriptTokenDataLoop*>(tokenData); }
-	CScriptTokenDataTry &Try() { ASSERT(LEX_TOKEN_DATA_TRY(token)); return *dynamic_cast<CScriptTokenDataTry*>(tokenData); }
-	CScriptTokenDataForwards &Forwarder() { ASSERT(LEX_TOKEN_DATA_FORWARDER(token)); return *dynamic_cast<CScriptTokenDataForwards*>(tokenData); }
+	// the token determines the type of the token-data -> no dynamic_cast needed
+	const std::string &String() { ASSERT(LEX_TOKEN_DATA_STRING(token)); return static_cast<CScriptTokenDataString*>(tokenData)->tokenStr; }
+	CScriptTokenDataNumber &Number() { ASSERT(LEX_TOKEN_DATA_NUMBER(token)); return *static_cast<CScriptTokenDataNumber*>(tokenData); }
+	double &Float() { ASSERT(LEX_TOKEN_DATA_FLOAT(token)); return Number().floatData; }
+	CScriptTokenDataLiteral &Literal() { ASSERT(LEX_TOKEN_DATA_LITERAL(token)); return *static_cast<CScriptTokenDataLiteral*>(tokenData); }
+	CScriptTokenDataFnc &Fnc() { ASSERT(LEX_TOKEN_DATA_FUNCTION(token)); return *static_cast<CScriptTokenDataFnc*>(tokenData); }
+	const CScriptTokenDataFnc &Fnc() const { ASSERT(LEX_TOKEN_DATA_FUNCTION(token)); return *static_cast<CScriptTokenDataFnc*>(tokenData); }
+	CScriptTokenDataObjectLiteral &Object() { ASSERT(LEX_TOKEN_DATA_OBJECT_LITERAL(token)); return *static_cast<CScriptTokenDataObjectLiteral*>(tokenData); }
+	CScriptTokenDataDestructuringVar &DestructuringVar() { ASSERT(LEX_TOKEN_DATA_DESTRUCTURING_VAR(token)); return *static_cast<CScriptTokenDataDestructuringVar*>(tokenData); }
+	CScriptTokenDataLoop &Loop() { ASSERT(LEX_TOKEN_DATA_LOOP(token)); return *static_cast<CScriptTokenDataLoop*>(tokenData); }
+	CScriptTokenDataTry &Try() { ASSERT(LEX_TOKEN_DATA_TRY(token)); return *static_cast<CScriptTokenDataTry*>(tokenData); }
+	CScriptTokenDataForwards &Forwarder() { ASSERT(LEX_TOKEN_DATA_FORWARDER(token)); return *static_cast<CScriptTokenDataForwards*>(tokenData); }
+	CScriptTokenDataSwitchTable &SwitchTable() { ASSERT(LEX_TOKEN_DATA_SWITCH_TABLE(token)); return *static_cast<CScriptTokenDataSwitchTable*>(tokenData); }
 #ifdef _DEBUG
 	std::string token_str;
 #endif
@@ -528,14 +677,17 @@ public:
 	static std::string getTokenStr( int token, const char *tokenStr=0, bool *need_space=0 );
 	static const char *isReservedWord(int Token);
 	static int isReservedWord(const std::string &Str);
+	static int isReservedWord(const char *Str, size_t Len);
 private:
 
 	void clear();
 	union {
 		int										intData;
-		double									*floatData;
 		CScriptTokenData						*tokenData;
 	};
+	friend class CCodeCacheWriter;
+	friend class CCodeCacheReader;
+	friend class CConstantFolder;
 };
 
 
@@ -575,7 +727,17 @@ public:
 	CScriptTokenizer();
 	CScriptTokenizer(CScriptLex &Lexer);
 	CScriptTokenizer(const char *Code, const std::string &File="", int Line=0, int Column=0);
+	CScriptTokenizer(const CScript &Script); ///< executes the shared tokens of a compiled script
 	void tokenizeCode(CScriptLex &Lexer);
+	void tokenizeLazyBody(CScriptTokenDataFnc &Fnc);
+
+	/// pre-parse mode - function bodies are only lexed to find their end and are tokenized on the first call
+	/// syntax errors in a body are thrown on its first call; set it before scripts are compiled
+	static bool lazyFunctions;
+
+	/// constant folding - operators with constant operands and if-statements with a constant condition
+	/// are evaluated once after tokenizing (on by default)
+	static bool constantFolding;
 
 	CScriptToken &getToken() { return *(tokenScopeStack.back().pos); }
 	void getNextToken();
@@ -600,7 +762,7 @@ private:
 	void tokenizeFor(ScriptTokenState &State, int Flags);
 	CScriptToken tokenizeVarIdentifier(STRING_VECTOR_t *VarNames=0, bool *NeedAssignment=0);
 	CScriptToken tokenizeFunctionArgument();
-	void tokenizeArrowFunction(const TOKEN_VECT &Arguments, ScriptTokenState &State, int Flags, bool noLetDef=false);
+	void tokenizeArrowFunction(const TOKEN_VECT &Arguments, const char *Begin, ScriptTokenState &State, int Flags, bool noLetDef=false); ///< Begin = the start of the arguments in the code
 	void tokenizeFunction(ScriptTokenState &State, int Flags, bool noLetDef=false);
 	void tokenizeLet(ScriptTokenState &State, int Flags, bool noLetDef=false);
 	void tokenizeVarNoConst(ScriptTokenState &State, int Flags);
@@ -629,8 +791,95 @@ private:
 	void throwTokenNotExpected();
 	CScriptLex *l;
 	TOKEN_VECT tokens;
+	CScriptTokenDataPtr<CScriptTokenDataScript> script; ///< keeps the tokens of a CScript alive
+	CScriptTokenDataPtr<CScriptTokenDataSource> source; ///< the source of the functions (created by the first function)
 	ScriptTokenPosition prevPos;
 	std::vector<ScriptTokenPosition> tokenScopeStack;
+	friend class CScript;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScript - a compiled script: tokenized once, executed many times
+//////////////////////////////////////////////////////////////////////////
+
+class CScriptTokenDataScript : public fixed_size_object<CScriptTokenDataScript>, public CScriptTokenData {
+public:
+	CScriptTokenDataScript() : sourceHash(0), sourceSize(0), line(0), column(0) {}
+	TOKEN_VECT tokens;
+	std::string file;
+	uint64_t sourceHash; ///< identifies the source of a saved image (see CScript::save)
+	uint32_t sourceSize;
+	int line;
+	int column;
+};
+
+/// an immutable compiled script - copies share the tokens
+/** all lazy analyses of the tokens are done by the compiler, so the same CScript can be executed
+	in one or more contexts (also in different threads, each context in one thread at a time).
+	example:
+	\code
+		CScript rule = CTinyJS::compile(code, "rule.js");
+		for(...) { js.getRoot()->addChild("input", ...); js.execute(rule); }
+	\endcode
+*/
+class CScript {
+public:
+	CScript() {}
+	CScript(const char *Code, const std::string &File="", int Line=0, int Column=0);
+	CScript(const std::string &Code, const std::string &File="", int Line=0, int Column=0);
+	/// takes the ownership of Source - the functions reference its text instead of a copy (the source lives as long as they do)
+	/// the text of a mapped file is copied by the first function - the file may change after the compile
+	CScript(CScriptSource *Source, const std::string &File="", int Line=0, int Column=0);
+	bool isCompiled() const { return const_cast<CScript*>(this)->data; }
+	const std::string &getFile() const { return const_cast<CScript*>(this)->data->file; }
+
+	/// code cache - a versioned binary image of the tokens (see CTinyJS::compileCached)
+	/// returns false if the script isn't compiled or a lazy function body has a syntax error
+	bool save(std::string &Image) const;
+	/// restores a saved image - returns an uncompiled CScript if the image is invalid or was saved for another source
+	static CScript load(const char *Image, size_t Size, const std::string &Code, const std::string &File="", int Line=0, int Column=0);
+	static CScript load(const char *Image, size_t Size, const char *Code, size_t CodeSize, const std::string &File="", int Line=0, int Column=0);
+	static uint64_t hashSource(const char *Code, size_t Size);
+private:
+	void compile(const char *Code, const std::string &File, int Line, int Column);
+	void compile(const char *Code, size_t Size, const CScriptTokenDataPtr<CScriptTokenDataSource> &Source, const std::string &File, int Line, int Column);
+	static CScript load(const char *Image, size_t Size, const char *Code, size_t CodeSize, const CScriptTokenDataPtr<CScriptTokenDataSource> &Source, const std::string &File, int Line, int Column);
+	CScriptTokenDataPtr<CScriptTokenDataScript> data;
+	friend class CScriptTokenizer;
+	friend class CTinyJS;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+/// CScriptSource - a read-only view of a source text (nul-terminated)
+//////////////////////////////////////////////////////////////////////////
+
+/// the builtin reader of require maps the files into memory - the lexer reads directly from the mapping
+/** example:
+	\code
+		int Error;
+		if(CScriptSource *Source = CScriptSource::open("data.js", Error)) {
+			js.execute(Source->data(), "data.js");
+			delete Source;
+		}
+	\endcode
+*/
+class CScriptSource {
+public:
+	virtual ~CScriptSource() {}
+	const char *data() const { return Data; }
+	size_t size() const { return Size; }
+	virtual bool isMapped() const { return false; } ///< the text is a mapped file - it is only valid while the file is unchanged
+	/// maps the file read-only into memory (or reads it if it can't be mapped) - returns 0 and sets ErrorNo on failure
+	/// the file must not be truncated while it is mapped
+	static CScriptSource *open(const std::string &File, int &ErrorNo);
+	/// a source in a string - Code is swapped into the source (no copy)
+	static CScriptSource *fromString(std::string &Code);
+protected:
+	CScriptSource() : Data(""), Size(0) {}
+	const char *Data;
+	size_t Size;
 };
 
 
@@ -655,6 +904,12 @@ typedef void (*JSCallback)(const CFunctionsScopePtr &var, void *userdata);
 
 class CTinyJS;
 class CScriptResult;
+/// fast calling convention for native functions - the arguments as array, no function scope
+/// returns the result (0 = undefined), errors are thrown with CTinyJS::throwNativeError
+typedef CScriptVarPtr (*JSFastCallback)(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata);
+/// numeric intrinsics e.g. Math.floor - the arguments are already converted to numbers
+/// call-sites calling an unmodified intrinsic compute the result without a native call
+typedef CNumber (*JSNumberIntrinsic)(const CNumber *Args, size_t Argc);
 
 //////////////////////////////////////////////////////////////////////////
 /// CScriptVar
@@ -744,6 +999,11 @@ public:
 
 	CScriptVarPtr toIterator(int Mode=3);
 	CScriptVarPtr toIterator(CScriptResult &execute, int Mode=3);
+	/// one step of an iterator without the StopIteration-throw; returns false if done or on errors (execute is set)
+	/// the default calls the method "next" of this; the builtin iterators do it native
+	virtual bool iteratorNext(CScriptResult &execute, CScriptVarPtr &Value);
+	/// true if Next is the native next of a builtin iterator (not replaced by the script) -> iteratorNext can step without calling it
+	virtual bool isBuiltinNext(const CScriptVarPtr &Next); // { return false; }
 
 
 //	virtual std::string getParsableString(const std::string &indentString, const std::string &indent, bool &hasRecursion); ///< get Data as a parsable javascript string
@@ -789,7 +1049,6 @@ public:
 	CScriptVarLinkPtr findChildByPath(const std::string &path); ///< Tries to find a child with the given path (separated by dots)
 	CScriptVarLinkPtr findChildOrCreate(const std::string &childName/*, int varFlags=SCRIPTVAR_UNDEFINED*/); ///< Tries to find a child with the given name, or will create it with the given flags
 	CScriptVarLinkPtr findChildOrCreateByPath(const std::string &path); ///< Tries to find a child with the given path (separated by dots)
-	void keys(STRING_SET_t &Keys, bool OnlyEnumerable=true, uint32_t ID=0);
 	/// add & remove
 	CScriptVarLinkPtr addChild(const std::string &childName, const CScriptVarPtr &child, int linkFlags = SCRIPTVARLINK_DEFAULT);
 	CScriptVarLinkPtr DEPRECATED("addChildNoDup is deprecated use addChildOrReplace instead!") addChildNoDup(const std::string &childName, const CScriptVarPtr &child, int linkFlags = SCRIPTVARLINK_DEFAULT);
@@ -842,6 +1101,7 @@ public:
 	uint32_t temporaryMark[TEMPORARY_MARK_SLOTS];
 
 	friend class CScriptVarPtr;
+	friend class CScriptTokenDataLiteral;
 };
 
 
@@ -1075,7 +1335,7 @@ private:
 define_ScriptVarPtr_Type(Primitive);
 class CScriptVarPrimitive : public CScriptVar {
 protected:
-	CScriptVarPrimitive(CTinyJS *Context, const CScriptVarPtr &Prototype) : CScriptVar(Context, Prototype) { setExtensible(false); }
+	CScriptVarPrimitive(CTinyJS *Context, const CScriptVarPtr &Prototype);
 	CScriptVarPrimitive(const CScriptVarPrimitive &Copy) : CScriptVar(Copy) { } ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarPrimitive();
@@ -1156,7 +1416,7 @@ define_ScriptVarPtr_Type(String);
 class CScriptVarString : public CScriptVarPrimitive {
 protected:
 	CScriptVarString(CTinyJS *Context, const std::string &Data);
-	CScriptVarString(const CScriptVarString &Copy) : CScriptVarPrimitive(Copy), data(Copy.data) {} ///< Copy protected -> use clone for public
+	CScriptVarString(const CScriptVarString &Copy) : CScriptVarPrimitive(Copy), data(Copy.data), hash(Copy.hash) {} ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarString();
 	virtual CScriptVarPtr clone();
@@ -1174,9 +1434,11 @@ public:
 
 	uint32_t stringLength() { return data.size(); }
 	int getChar(uint32_t Idx);
+	uint32_t getHash(); ///< hash of data (calculated on first call and cached)
 protected:
 	std::string data;
 private:
+	uint32_t hash; ///< 0 = not calculated
 	friend define_newScriptVar_Fnc(String, CTinyJS *Context, const std::string &);
 	friend define_newScriptVar_Fnc(String, CTinyJS *Context, const char *);
 	friend define_newScriptVar_Fnc(String, CTinyJS *Context, char *);
@@ -1660,6 +1922,83 @@ private:
 inline define_newScriptVar_Fnc(FunctionNativeCallback, CTinyJS *Context, JSCallback Callback, void *Userdata, const char *Name=0) { return new CScriptVarFunctionNativeCallback(Context, Callback, Userdata, Name); }
 
 
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarFunctionNativeFast
+//////////////////////////////////////////////////////////////////////////
+
+define_ScriptVarPtr_Type(FunctionNativeFast);
+class CScriptVarFunctionNativeFast : public CScriptVarFunctionNative {
+protected:
+	CScriptVarFunctionNativeFast(CTinyJS *Context, JSFastCallback Callback, void *Userdata, const char *Name) : CScriptVarFunctionNative(Context, Userdata, Name), jsFastCallback(Callback), numberIntrinsic(0), thisArgument(-1) { }
+	CScriptVarFunctionNativeFast(CTinyJS *Context, JSNumberIntrinsic Intrinsic, const char *Name) : CScriptVarFunctionNative(Context, 0, Name), jsFastCallback(0), numberIntrinsic(Intrinsic), thisArgument(0) { }
+	CScriptVarFunctionNativeFast(const CScriptVarFunctionNativeFast &Copy) : CScriptVarFunctionNative(Copy), jsFastCallback(Copy.jsFastCallback), numberIntrinsic(Copy.numberIntrinsic), thisArgument(Copy.thisArgument) { } ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarFunctionNativeFast();
+	virtual CScriptVarPtr clone();
+	virtual void callFunction(const CFunctionsScopePtr &c); ///< called with a function scope
+	CScriptVarPtr callFunction(const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc);
+	JSNumberIntrinsic getNumberIntrinsic() { return numberIntrinsic; } ///< 0 = no intrinsic
+private:
+	JSFastCallback jsFastCallback; ///< Callback for native functions
+	JSNumberIntrinsic numberIntrinsic; ///< used instead of jsFastCallback
+	int thisArgument; ///< 1 = the first parameter is "this" e.g. "function String.charAt(this,pos)" / -1 = unknown
+	friend define_newScriptVar_Fnc(FunctionNativeFast, CTinyJS *Context, JSFastCallback Callback, void*, const char*);
+	friend define_newScriptVar_Fnc(FunctionNativeFast, CTinyJS *Context, JSNumberIntrinsic Intrinsic, const char*);
+};
+inline define_newScriptVar_Fnc(FunctionNativeFast, CTinyJS *Context, JSFastCallback Callback, void *Userdata, const char *Name=0) { return new CScriptVarFunctionNativeFast(Context, Callback, Userdata, Name); }
+inline define_newScriptVar_Fnc(FunctionNativeFast, CTinyJS *Context, JSNumberIntrinsic Intrinsic, const char *Name=0) { return new CScriptVarFunctionNativeFast(Context, Intrinsic, Name); }
+
+
+#ifdef HAVE_CXX11_VARIADIC_TEMPLATES
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarFunctionNativeTyped
+//////////////////////////////////////////////////////////////////////////
+
+/// argument converters for typed natives - only the types listed here can be used as parameters
+template<typename T> struct CNativeArgument { enum { supported = 0 }; };
+template<typename T> struct CNativeArgument<const T> : CNativeArgument<T> { };
+template<typename T> struct CNativeArgument<const T &> : CNativeArgument<T> { };
+template<> struct CNativeArgument<int32_t> { enum { supported = 1 }; static int32_t get(const CScriptVarPtr &v) { return v->toNumber().toInt32(); } };
+template<> struct CNativeArgument<uint32_t> { enum { supported = 1 }; static uint32_t get(const CScriptVarPtr &v) { return v->toNumber().toUInt32(); } };
+template<> struct CNativeArgument<double> { enum { supported = 1 }; static double get(const CScriptVarPtr &v) { return v->toNumber().toDouble(); } };
+template<> struct CNativeArgument<bool> { enum { supported = 1 }; static bool get(const CScriptVarPtr &v) { return v->toBoolean(); } };
+template<> struct CNativeArgument<CNumber> { enum { supported = 1 }; static CNumber get(const CScriptVarPtr &v) { return v->toNumber(); } };
+template<> struct CNativeArgument<std::string> { enum { supported = 1 }; static std::string get(const CScriptVarPtr &v) { return v->toString(); } };
+#if __cplusplus >= 201703L
+/// the temporary string lives until the native returns
+template<> struct CNativeArgument<std::string_view> : CNativeArgument<std::string> { };
+#endif
+template<> struct CNativeArgument<CScriptVarPtr> { enum { supported = 1 }; static const CScriptVarPtr &get(const CScriptVarPtr &v) { return v; } };
+
+/// CNativeArguments<A...>::enabled exists only if all parameter types are supported
+template<typename... A> struct CNativeArguments;
+template<> struct CNativeArguments<> { typedef CScriptVarFunctionNativePtr enabled; };
+struct CNativeArgumentsDisabled { };
+template<typename A0, typename... A> struct CNativeArguments<A0, A...> : std::conditional<CNativeArgument<A0>::supported, CNativeArguments<A...>, CNativeArgumentsDisabled>::type { };
+
+template<size_t... I> struct CNativeIndexList { };
+template<size_t N, size_t... I> struct CNativeMakeIndexList : CNativeMakeIndexList<N-1, N-1, I...> { };
+template<size_t... I> struct CNativeMakeIndexList<0, I...> { typedef CNativeIndexList<I...> type; };
+
+/// a fast native whose callback unpacks the arguments for a typed C++ function or member function (see CTinyJS::addNative)
+template<class Binder>
+class CScriptVarFunctionNativeTyped : public CScriptVarFunctionNativeFast {
+protected:
+	CScriptVarFunctionNativeTyped(CTinyJS *Context, const Binder &Bind, const char *Name) : CScriptVarFunctionNativeFast(Context, invoke, 0, Name), binder(Bind) { jsUserData = &binder; }
+	CScriptVarFunctionNativeTyped(const CScriptVarFunctionNativeTyped &Copy) : CScriptVarFunctionNativeFast(Copy), binder(Copy.binder) { jsUserData = &binder; } ///< Copy protected -> use clone for public
+public:
+	virtual CScriptVarPtr clone() { return new CScriptVarFunctionNativeTyped(*this); }
+private:
+	static CScriptVarPtr invoke(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) { return (*static_cast<Binder*>(userdata))(Context, Args, Argc); }
+	Binder binder; ///< the C++ function (and object) - jsUserData points to it
+	template<class Binder2>
+	friend define_newScriptVar_NamedFnc(FunctionNativeTyped, CTinyJS *Context, const Binder2 &Bind, const char *Name);
+};
+template<class Binder>
+define_newScriptVar_NamedFnc(FunctionNativeTyped, CTinyJS *Context, const Binder &Bind, const char *Name=0) { return new CScriptVarFunctionNativeTyped<Binder>(Context, Bind, Name); }
+#endif /*HAVE_CXX11_VARIADIC_TEMPLATES*/
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarFunctionNativeClass
 //////////////////////////////////////////////////////////////////////////
@@ -1756,6 +2095,7 @@ public:
 	virtual CScriptVarPtr scopeLet(); ///< to create var like: let a = ...
 	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
 	virtual CScriptVarScopePtr getParent();
+	virtual bool hasStaticNames(); ///< true if all names of the scope chain are known (no with, no hidden let-scope)
 	friend define_newScriptVar_Fnc(Scope, CTinyJS *Context, Scope_t);
 };
 inline define_newScriptVar_Fnc(Scope, CTinyJS *Context, Scope_t) { return new CScriptVarScope(Context); }
@@ -1770,10 +2110,12 @@ define_ScriptVarPtr_Type(ScopeFnc);
 class CScriptVarScopeFnc : public CScriptVarScope {
 protected: // only derived classes or friends can be created
 	CScriptVarScopeFnc(CTinyJS *Context, const CScriptVarScopePtr &Closure) // constructor for FncScope
-		: CScriptVarScope(Context), closure(Closure ? addChild(TINYJS_FUNCTION_CLOSURE_VAR, Closure, 0) : CScriptVarLinkPtr()) {}
+		: CScriptVarScope(Context), closure(Closure ? addChild(TINYJS_FUNCTION_CLOSURE_VAR, Closure, 0) : CScriptVarLinkPtr()), dynamicNames(false) {}
 public:
 	virtual ~CScriptVarScopeFnc();
 	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
+	virtual bool hasStaticNames();
+	void setDynamicNames() { dynamicNames = true; } ///< the function uses eval or require -> the names of the scope are not predictable
 	
 	void setReturnVar(const CScriptVarPtr &var); ///< Set the result value. Use this when setting complex return data as it avoids a deepCopy()
 	
@@ -1789,6 +2131,7 @@ public:
 
 protected:
 	CScriptVarLinkPtr closure;
+	bool dynamicNames;
 	friend define_newScriptVar_Fnc(ScopeFnc, CTinyJS *Context, ScopeFnc_t, const CScriptVarScopePtr &Closure);
 };
 inline define_newScriptVar_Fnc(ScopeFnc, CTinyJS *Context, ScopeFnc_t, const CScriptVarScopePtr &Closure) { return new CScriptVarScopeFnc(Context, Closure); }
@@ -1809,7 +2152,9 @@ public:
 	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
 	virtual CScriptVarPtr scopeVar(); ///< to create var like: var a = ...
 	virtual CScriptVarScopePtr getParent();
+	virtual bool hasStaticNames();
 	void setletExpressionInitMode(bool Mode) { letExpressionInitMode = Mode; }
+	void reset(const CScriptVarScopePtr &Parent); ///< drops all lets and sets a new parent (0 = none) -> to reuse an unreferenced scope
 protected:
 	CScriptVarLinkPtr parent;
 	bool letExpressionInitMode;
@@ -1833,6 +2178,7 @@ public:
 	virtual ~CScriptVarScopeWith();
 	virtual CScriptVarPtr scopeLet(); ///< to create var like: let a = ...
 	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
+	virtual bool hasStaticNames(); // { return false; }
 private:
 	CScriptVarLinkPtr with;
 	friend define_newScriptVar_Fnc(ScopeWith, CTinyJS *Context, ScopeWith_t, const CScriptVarScopePtr &Parent, const CScriptVarPtr &With);
@@ -1840,6 +2186,55 @@ private:
 inline define_newScriptVar_Fnc(ScopeWith, CTinyJS *, ScopeWith_t, const CScriptVarScopePtr &Parent, const CScriptVarPtr &With) { return new CScriptVarScopeWith(Parent, With); }
 
 
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarScopeClosure
+//////////////////////////////////////////////////////////////////////////
+
+/// the closure of a function - holds only the links of the names used by the function.
+/// The links are shared with the defining scopes, so both sides see each other's assignments.
+define_dummy_t(ScopeClosure);
+define_ScriptVarPtr_Type(ScopeClosure);
+class CScriptVarScopeClosure : public CScriptVarScopeLet {
+protected:
+	CScriptVarScopeClosure(CTinyJS *Context);
+public:
+	virtual ~CScriptVarScopeClosure();
+	virtual CScriptVarLinkWorkPtr findInScopes(const std::string &childName);
+	void addCapturedLink(const CScriptVarLinkPtr &Link);
+private:
+	friend define_newScriptVar_Fnc(ScopeClosure, CTinyJS *Context, ScopeClosure_t);
+};
+inline define_newScriptVar_Fnc(ScopeClosure, CTinyJS *Context, ScopeClosure_t) { return new CScriptVarScopeClosure(Context); }
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptKeysIterator
+//////////////////////////////////////////////////////////////////////////
+
+/// walks the property names of an object without collecting them.
+/// The chars of a string object come first, then the Childs in their sorted order.
+/// With WithPrototypes the not shadowed names of the prototype chain follow.
+/// Childs added or removed while walking are tolerated.
+class CScriptKeysIterator {
+public:
+	CScriptKeysIterator() : onlyEnumerable(true), withPrototypes(false), charIdx(0), charCount(0), pos(0) {} ///< an empty iterator - see start
+	CScriptKeysIterator(const CScriptVarPtr &Object, bool OnlyEnumerable=true, bool WithPrototypes=false);
+	/// (re)starts the iteration with the keys of Object
+	void start(const CScriptVarPtr &Object, bool OnlyEnumerable=true, bool WithPrototypes=false);
+	/// returns false at the end; Link is cleared for string chars
+	bool next(std::string &Key, CScriptVarLinkPtr *Link=0);
+private:
+	void enterLevel(const CScriptVarPtr &Object);
+	bool isShadowed(const std::string &Key);
+	bool onlyEnumerable;
+	bool withPrototypes;
+	std::vector<CScriptVarPtr> levels; ///< the object and the entered prototypes
+	uint32_t charIdx, charCount;
+	SCRIPTVAR_CHILDS_t::size_type pos;
+	CScriptVarLinkPtr last; ///< the last visited Child of the current level
+};
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarDefaultIterator
 //////////////////////////////////////////////////////////////////////////
@@ -1853,24 +2248,134 @@ protected:
 	CScriptVarDefaultIterator(const CScriptVarDefaultIterator &Copy) 
 		: 
 		CScriptVarObject(Copy), mode(Copy.mode), object(Copy.object),
-		keys(Copy.keys), pos(keys.begin()){} ///< Copy protected -> use clone for public
+		keys(Copy.keys), builtinNext(Copy.builtinNext) {} ///< Copy protected -> use clone for public
 public:
 	virtual ~CScriptVarDefaultIterator();
 	virtual CScriptVarPtr clone();
 	virtual bool isIterator();
+	virtual bool iteratorNext(CScriptResult &execute, CScriptVarPtr &Value);
+	virtual bool isBuiltinNext(const CScriptVarPtr &Next);
+
+	/// the step of the default iteration; used by the for-in loop without an iterator object
+	static bool next(CScriptKeysIterator &Keys, const CScriptVarPtr &Object, int Mode, CScriptVarPtr &Value);
 
 	void native_next(const CFunctionsScopePtr &c, void *data);
 private:
 	int mode;
 	CScriptVarPtr object;
-	STRING_SET_t keys;
-	STRING_SET_it pos;
+	CScriptKeysIterator keys;
+	CScriptVarPtr builtinNext;
 	friend define_newScriptVar_NamedFnc(DefaultIterator, CTinyJS *, const CScriptVarPtr &, int);
 
 };
 inline define_newScriptVar_NamedFnc(DefaultIterator, CTinyJS *Context, const CScriptVarPtr &Object, int Mode) { return new CScriptVarDefaultIterator(Context, Object, Mode); }
 
 
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarMap (Map, Set, WeakMap, WeakSet)
+//////////////////////////////////////////////////////////////////////////
+
+define_dummy_t(Map);
+define_ScriptVarPtr_Type(Map);
+
+class CScriptVarMap : public CScriptVarObject {
+public:
+	enum KIND {
+		MAP			= 0,
+		SET			= 1,
+		WEAK			= 2,
+		WEAKMAP		= WEAK,
+		WEAKSET		= WEAK|SET
+	};
+protected:
+	CScriptVarMap(CTinyJS *Context, int Kind);
+	CScriptVarMap(const CScriptVarMap &Copy) 
+		: 
+		CScriptVarObject(Copy), kind(Copy.kind), used(Copy.used), iterators(0),
+		entries(Copy.entries), buckets(Copy.buckets) {} ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarMap();
+	virtual CScriptVarPtr clone();
+
+	virtual void removeAllChildren();
+	virtual std::string getVarTypeTagName(); ///< "Map", "Set", "WeakMap" or "WeakSet"
+	virtual void setTemporaryMark_recursive(uint32_t ID);
+
+	int getKind() { return kind; }
+	uint32_t size() { return used; }
+
+	CScriptVarPtr get(const CScriptVarPtr &Key); ///< returns an empty Ptr if Key not found
+	bool has(const CScriptVarPtr &Key) { return findEntry(Key, getHash(Key)) >= 0; }
+	void set(const CScriptVarPtr &Key, const CScriptVarPtr &Value);
+	bool remove(const CScriptVarPtr &Key);
+	void clear();
+
+	/// iterates the entries in insertion order; Cursor starts with 0
+	bool getEntry(uint32_t &Cursor, CScriptVarPtr &Key, CScriptVarPtr &Value);
+	/// while iterators are locked removed entries are not compacted so Cursors stay valid
+	void lockIterators() { iterators++; }
+	void unlockIterators() { if(--iterators==0 && entries.size()-used > used) compact(); }
+	class CIteratorLock {
+	public:
+		CIteratorLock(const CScriptVarMapPtr &Map) : map(Map) { map->lockIterators(); }
+		~CIteratorLock() { map->unlockIterators(); }
+	private:
+		CScriptVarMapPtr map;
+	};
+
+	static uint32_t getHash(const CScriptVarPtr &Key);
+	static bool sameValueZero(const CScriptVarPtr &lhs, const CScriptVarPtr &rhs);
+private:
+	struct ENTRY {
+		CScriptVarPtr key; ///< an empty key marks a removed entry
+		CScriptVarPtr value;
+		uint32_t hash;
+	};
+	int32_t findEntry(const CScriptVarPtr &Key, uint32_t Hash);
+	void rehash(uint32_t Buckets);
+	void compact();
+
+	int kind;
+	uint32_t used;
+	int iterators;
+	std::vector<ENTRY> entries; ///< in insertion order
+	std::vector<int32_t> buckets; ///< open addressing; index into entries or -1
+	friend define_newScriptVar_NamedFnc(Map, CTinyJS *Context, int Kind);
+};
+inline define_newScriptVar_NamedFnc(Map, CTinyJS *Context, int Kind) { return new CScriptVarMap(Context, Kind); }
+
+
+////////////////////////////////////////////////////////////////////////// 
+/// CScriptVarMapIterator
+//////////////////////////////////////////////////////////////////////////
+
+define_dummy_t(MapIterator);
+define_ScriptVarPtr_Type(MapIterator);
+
+class CScriptVarMapIterator : public CScriptVarObject {
+protected:
+	CScriptVarMapIterator(CTinyJS *Context, const CScriptVarMapPtr &Map, int Mode);
+	CScriptVarMapIterator(const CScriptVarMapIterator &Copy);  ///< Copy protected -> use clone for public
+public:
+	virtual ~CScriptVarMapIterator();
+	virtual CScriptVarPtr clone();
+	virtual bool isIterator();
+	virtual bool iteratorNext(CScriptResult &execute, CScriptVarPtr &Value);
+	virtual bool isBuiltinNext(const CScriptVarPtr &Next);
+	virtual void setTemporaryMark_recursive(uint32_t ID);
+
+	void native_next(const CFunctionsScopePtr &c, void *data);
+private:
+	int mode;
+	CScriptVarMapPtr map; ///< cleared if the iterator is exhausted
+	uint32_t cursor;
+	CScriptVarPtr builtinNext;
+	friend define_newScriptVar_NamedFnc(MapIterator, CTinyJS *, const CScriptVarMapPtr &, int);
+
+};
+inline define_newScriptVar_NamedFnc(MapIterator, CTinyJS *Context, const CScriptVarMapPtr &Map, int Mode) { return new CScriptVarMapIterator(Context, Map, Mode); }
+
+
 ////////////////////////////////////////////////////////////////////////// 
 /// CScriptVarGenerator
 //////////////////////////////////////////////////////////////////////////
@@ -1898,6 +2403,8 @@ public:
 	virtual CScriptVarPtr clone();
 	virtual bool isIterator();
 	virtual bool isGenerator();
+	virtual bool iteratorNext(CScriptResult &execute, CScriptVarPtr &Value);
+	virtual bool isBuiltinNext(const CScriptVarPtr &Next);
 	virtual std::string getVarType(); // { return "generator"; }
 	virtual std::string getVarTypeTagName(); // { return "Generator"; }
 
@@ -2002,6 +2509,7 @@ public:
 //////////////////////////////////////////////////////////////////////////
 
 typedef int (*native_require_read_fnc)(const std::string &Fname, std::string &Data);
+typedef CScriptSource *(*native_require_source_fnc)(const std::string &Fname, int &ErrorNo); ///< returns 0 and sets ErrorNo on failure
 
 class CTinyJS {
 public:
@@ -2011,6 +2519,18 @@ public:
 	void execute(CScriptTokenizer &Tokenizer);
 	void execute(const char *Code, const std::string &File="", int Line=0, int Column=0);
 	void execute(const std::string &Code, const std::string &File="", int Line=0, int Column=0);
+	void execute(const CScript &Script);
+	/// tokenize the code once - the returned CScript can be executed many times in any context
+	static CScript compile(const std::string &Code, const std::string &File="", int Line=0, int Column=0);
+	/// like compile but loads the tokens from a code cache file (default File+".tjsc")
+	/// a missing, stale or invalid cache file is (re)written
+	static CScript compileCached(const std::string &Code, const std::string &File, const std::string &CacheFile="");
+	static CScript compileCached(const char *Code, size_t Size, const std::string &File, const std::string &CacheFile="");
+	static CScript compileCached(CScriptSource *Source, const std::string &File, const std::string &CacheFile=""); ///< takes the ownership of Source (see CScript)
+	/// compiles independent sources concurrently on Threads worker threads (0 = one per CPU) - Scripts[i] is the compiled Codes[i]
+	/// all sources are compiled, then the first syntax error (in the order of Codes) is thrown
+	static void compile(const STRING_VECTOR_t &Codes, const STRING_VECTOR_t &Files, std::vector<CScript> &Scripts, int Threads=0);
+	void execute(const std::vector<CScript> &Scripts); ///< executes the scripts in order
 	/** Evaluate the given code and return a link to a javascript object,
 	 * useful for (dangerous) JSON parsing. If nothing to return, will return
 	 * 'undefined' variable type. CScriptVarLink is returned as this will
@@ -2029,6 +2549,7 @@ public:
 	 * automatically unref the result as it goes out of scope. If you want to
 	 * keep it, you must use ref() and unref() */
 	CScriptVarLinkPtr evaluateComplex(const std::string &code, const std::string &File="", int Line=0, int Column=0);
+	CScriptVarLinkPtr evaluateComplex(const CScript &Script);
 	/** Evaluate the given code and return a string. If nothing to return, will return
 	 * 'undefined' */
 	std::string evaluate(CScriptTokenizer &Tokenizer);
@@ -2038,12 +2559,21 @@ public:
 	/** Evaluate the given code and return a string. If nothing to return, will return
 	 * 'undefined' */
 	std::string evaluate(const std::string &code, const std::string &File="", int Line=0, int Column=0);
+	std::string evaluate(const CScript &Script);
 
 	native_require_read_fnc setRequireReadFnc(native_require_read_fnc fnc) { 
 		native_require_read_fnc old = native_require_read;
 		native_require_read = fnc;
 		return old;
 	}
+	/// like setRequireReadFnc but the callback returns a view of the source (e.g. a mapped file) - a read-function is used first
+	native_require_source_fnc setRequireSourceFnc(native_require_source_fnc fnc) {
+		native_require_source_fnc old = native_require_source;
+		native_require_source = fnc;
+		return old;
+	}
+	/// require() uses the code cache (compileCached) for files read by the builtin reader
+	void setCodeCache(bool Enable) { codeCache = Enable; }
 
 	/// add a native function to be called from TinyJS
 	/** example:
@@ -2072,11 +2602,30 @@ public:
 	*/
 
 	CScriptVarFunctionNativePtr addNative(const std::string &funcDesc, JSCallback ptr, void *userdata=0, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT);
+	CScriptVarFunctionNativePtr addNative(const std::string &funcDesc, JSFastCallback ptr, void *userdata=0, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT);
+	CScriptVarFunctionNativePtr addNative(const std::string &funcDesc, JSNumberIntrinsic ptr, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT);
+	void throwNativeError(ERROR_TYPES ErrorType, const std::string &message); ///< throws a catchable Error out of a native function
 	template<class C>
 	CScriptVarFunctionNativePtr addNative(const std::string &funcDesc, C *class_ptr, void(C::*class_fnc)(const CFunctionsScopePtr &, void *), void *userdata=0, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT)
 	{
 		return addNative(funcDesc, ::newScriptVar<C>(this, class_ptr, class_fnc, userdata), LinkFlags);
 	}
+#ifdef HAVE_CXX11_VARIADIC_TEMPLATES
+	/// add a typed C++ function - the arguments are converted and the result is boxed automatically
+	/** supported parameter types are int32_t, uint32_t, double, bool, CNumber, std::string (std::string_view with C++17)
+		and CScriptVarPtr; missing arguments are passed as undefined. example:
+		\code
+			static double hypot(double a, double b) { return sqrt(a*a+b*b); }
+			tinyJS->addNative("function Math.hypot(a,b)", hypot);
+		\endcode
+	*/
+	template<typename R, typename... A>
+	typename CNativeArguments<A...>::enabled addNative(const std::string &funcDesc, R (*fnc)(A...), int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT);
+	template<class C, typename R, typename... A>
+	typename CNativeArguments<A...>::enabled addNative(const std::string &funcDesc, C *class_ptr, R (C::*class_fnc)(A...), int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT);
+	template<class C, typename R, typename... A>
+	typename CNativeArguments<A...>::enabled addNative(const std::string &funcDesc, const C *class_ptr, R (C::*class_fnc)(A...) const, int LinkFlags=SCRIPTVARLINK_BUILDINDEFAULT);
+#endif /*HAVE_CXX11_VARIADIC_TEMPLATES*/
 
 	/// Send all variables to stdout
 	void trace();
@@ -2111,15 +2660,104 @@ private:
 	public:
 		CScopeControl(CTinyJS *Context) : context(Context), count(0) {} 
 		~CScopeControl() { clear(); }
-		void clear() { while(count--) {CScriptVarScopePtr parent = context->scopes.back()->getParent(); if(parent) context->scopes.back() = parent; else context->scopes.pop_back() ;} count=0; } 
+		void clear() { 
+			while(count--) {
+				CScriptVarScopePtr scope = context->scopes.back(), parent = scope->getParent(); 
+				if(parent) { context->scopes.back() = parent; context->recycleLetScope(scope); }
+				else context->scopes.pop_back();
+			} 
+			count=0; 
+		} 
 		void addFncScope(const CScriptVarScopePtr &Scope) { context->scopes.push_back(Scope); count++; }
-		CScriptVarScopeLetPtr addLetScope() {	count++; return context->scopes.back() = ::newScriptVar(context, ScopeLet, context->scopes.back()); }
+		CScriptVarScopeLetPtr addLetScope() {	count++; return context->scopes.back() = context->newLetScope(context->scopes.back()); }
 		void addWithScope(const CScriptVarPtr &With) { context->scopes.back() = ::newScriptVar(context, ScopeWith, context->scopes.back(), With); count++; }  
 	private:
 		CTinyJS *context;
 		int		count;
 	};
 	friend class CScopeControl;
+
+	class CArgumentsBuffer { // helper-class to reuse the argument vectors of calls
+	private:
+		CArgumentsBuffer(const CArgumentsBuffer& Copy) MEMBER_DELETE; // no copy
+		CArgumentsBuffer& operator =(const CArgumentsBuffer& Copy) MEMBER_DELETE;
+	public:
+		CArgumentsBuffer(CTinyJS *Context) : context(Context) {
+			if(context->argumentsPool.size()) {
+				arguments.swap(context->argumentsPool.back());
+				context->argumentsPool.pop_back();
+			}
+		}
+		~CArgumentsBuffer() {
+			arguments.clear(); // keeps the capacity
+			if(context->argumentsPool.size() < ARGUMENTS_POOL_SIZE) {
+				context->argumentsPool.push_back(std::vector<CScriptVarPtr>());
+				context->argumentsPool.back().swap(arguments);
+			}
+		}
+		std::vector<CScriptVarPtr> arguments;
+	private:
+		CTinyJS *context;
+	};
+	friend class CArgumentsBuffer;
+	enum { ARGUMENTS_POOL_SIZE = 32 };
+	std::vector<std::vector<CScriptVarPtr> > argumentsPool; ///< capacity is reserved -> no reallocation
+
+	/// call-site inline cache - remembers the function last called by a call-site (the '(' token of the call)
+	struct CALLSITE {
+		CALLSITE() : site(0), fnc(0), kind(CALL_FUNCTION) {}
+		const CScriptToken *site;
+		CScriptVarPtr function; ///< released by the garbage collector
+		CScriptTokenDataFnc *fnc;
+		enum { CALL_FUNCTION, CALL_DIRECT, CALL_FAST, CALL_INTRINSIC } kind; ///< callFunction, callFunctionDirect (simple parameters), callFunctionFast or a JSNumberIntrinsic
+	};
+	enum { INTRINSIC_MAX_ARGS = 4 }; ///< more arguments are passed with callFunctionFast
+	enum { CALLSITE_CACHE_SIZE = 256 };
+	CALLSITE callSiteCache[CALLSITE_CACHE_SIZE];
+	/// the Vars of the number- and string-literals (the token-data can't own a Var of a context)
+	struct LITERAL {
+		LITERAL() : serial(0) {}
+		uint32_t serial;
+		CScriptVarPtr var;
+	};
+	enum { LITERAL_CACHE_SIZE = 1024 };
+	LITERAL literalCache[LITERAL_CACHE_SIZE];
+	void clearLiteralCache();
+	void clearCallSiteCache();
+public:
+	struct CALL_STATISTICS {
+		CALL_STATISTICS() : calls(0), hits(0), misses(0), directCalls(0), fastCalls(0), intrinsicCalls(0), evalHits(0), evalMisses(0) {}
+		unsigned long calls;			///< calls executed by call-sites
+		unsigned long hits;			///< the call-site has called the same function before
+		unsigned long misses;
+		unsigned long directCalls;	///< calls with simple parameters (from call-sites and natives)
+		unsigned long fastCalls;		///< calls of native functions with the fast calling convention
+		unsigned long intrinsicCalls;	///< intrinsics computed by call-sites without a native call
+		unsigned long evalHits;		///< eval and Function have found the source text in the eval cache
+		unsigned long evalMisses;
+	};
+	const CALL_STATISTICS &getCallStatistics() { return callStatistics; }
+	void resetCallStatistics() { callStatistics = CALL_STATISTICS(); }
+	/// the number of source texts of eval and Function that are kept compiled (0 disables the eval cache)
+	/// and their total length in bytes - a text longer than an eighth of MaxBytes is compiled without caching
+	void setEvalCacheSize(size_t Size, size_t MaxBytes=1<<20);
+private:
+	CALL_STATISTICS callStatistics;
+
+	/// the eval cache - the compiled source texts of eval and Function, the most recently used first
+	typedef std::list<std::pair<std::string, CScript> > EVAL_CACHE_t;
+	struct EVAL_CACHE_KEY_LESS { bool operator()(const std::string *a, const std::string *b) const { return *a < *b; } };
+	typedef std::map<const std::string *, EVAL_CACHE_t::iterator, EVAL_CACHE_KEY_LESS> EVAL_CACHE_INDEX_t; ///< keyed by the key in the list (not copied)
+	EVAL_CACHE_t evalCache;
+	EVAL_CACHE_INDEX_t evalCacheIndex;
+	size_t evalCacheSize;
+	size_t evalCacheBytes; ///< the total length of the keys in the cache
+	size_t evalCacheMaxBytes;
+	CScript compileEval(const std::string &Code, const std::string &File);
+
+	CScriptVarScopeLetPtr newLetScope(const CScriptVarScopePtr &Parent);
+	void recycleLetScope(CScriptVarScopePtr &Scope);
+	std::vector<CScriptVarScopeLetPtr> letScopePool; ///< unreferenced let-scopes for reuse
 public:
 	CScriptVarPtr objectPrototype; /// Built in object class
 	CScriptVarPtr objectPrototype_valueOf; /// Built in object class
@@ -2130,8 +2768,13 @@ public:
 	CScriptVarPtr numberPrototype; /// Built in number class
 	CScriptVarPtr booleanPrototype; /// Built in boolean class
 	CScriptVarPtr iteratorPrototype; /// Built in iterator class
+	CScriptVarPtr mapPrototype; /// Built in map class
+	CScriptVarPtr setPrototype; /// Built in set class
+	CScriptVarPtr weakMapPrototype; /// Built in weakmap class
+	CScriptVarPtr weakSetPrototype; /// Built in weakset class
 #ifndef NO_GENERATORS
 	CScriptVarPtr generatorPrototype; /// Built in generator class
+	CScriptVarPtr generatorPrototype_next; /// Built in generator class
 #endif /*NO_GENERATORS*/
 	CScriptVarPtr functionPrototype; /// Built in function class
 	const CScriptVarPtr &getErrorPrototype(ERROR_TYPES Type) { return errorPrototypes[Type]; }
@@ -2165,6 +2808,12 @@ public:
 	// function call
 	CScriptVarPtr callFunction(const CScriptVarFunctionPtr &Function, std::vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis=0);
 	CScriptVarPtr callFunction(CScriptResult &execute, const CScriptVarFunctionPtr &Function, std::vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis=0);
+private:
+	CScriptVarPtr callFunctionDirect(CScriptResult &execute, const CScriptVarFunctionPtr &Function, CScriptTokenDataFnc *Fnc, std::vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis);
+	CScriptVarPtr callFunctionBody(CScriptResult &execute, const CScriptVarFunctionPtr &Function, CScriptTokenDataFnc *Fnc, const CScriptVarScopeFncPtr &functionRoot, CScriptVarPtr *newThis);
+	CScriptVarPtr callFunctionFast(CScriptResult &execute, CScriptVarFunctionNativeFast *Function, std::vector<CScriptVarPtr> &Arguments, const CScriptVarPtr &This, CScriptVarPtr *newThis);
+	void nativeException(CScriptResult &execute, const CScriptVarPtr &Exception, const std::string &FunctionName);
+public:
 	//////////////////////////////////////////////////////////////////////////
 #ifndef NO_GENERATORS
 	std::vector<CScriptVarGenerator *> generatorStack;
@@ -2178,8 +2827,11 @@ public:
 private:
 	void assign_destructuring_var(CScriptResult &execute, const CScriptTokenDataDestructuringVar &Objc, const CScriptVarPtr &Val, const CScriptVarPtr &Scope);
 	void execute_var_init(CScriptResult &execute, bool hideLetScope);
+	void execute_scope_template(const CScriptVarPtr &Scope, CScriptTokenDataForwards::SLOTS_t &Slots);
 	void execute_destructuring(CScriptResult &execute, CScriptTokenDataObjectLiteral &Objc, const CScriptVarPtr &Val, const std::string &Path);
+	CScriptVarPtr literalScriptVar(CScriptToken &Token);
 	CScriptVarLinkWorkPtr execute_literals(CScriptResult &execute);
+	void execute_literal_boilerplate(CScriptResult &execute, CScriptTokenDataObjectLiteral &Objc, const CScriptVarPtr &Obj);
 	CScriptVarLinkWorkPtr execute_member(CScriptVarLinkWorkPtr &parent, CScriptResult &execute);
 	CScriptVarLinkWorkPtr execute_function_call(CScriptResult &execute);
 	bool execute_unary_rhs(CScriptResult &execute, CScriptVarLinkWorkPtr& a);
@@ -2198,6 +2850,7 @@ private:
 	void execute_statement(CScriptResult &execute);
 	// parsing utility functions
 	CScriptVarLinkWorkPtr parseFunctionDefinition(const CScriptToken &FncToken);
+	CScriptVarPtr captureClosure(CScriptTokenDataFnc &Fnc);
 	CScriptVarLinkWorkPtr parseFunctionsBodyFromString(const std::string &ArgumentList, const std::string &FncBody);
 public:
 	CScriptVarLinkPtr findInScopes(const std::string &childName); ///< Finds a child, looking recursively up the scopes
@@ -2213,6 +2866,7 @@ public:
 	void throwException(ERROR_TYPES ErrorType, const std::string &message);
 	void throwError(CScriptResult &execute, ERROR_TYPES ErrorType, const std::string &message, CScriptTokenizer::ScriptTokenPosition &Pos);
 	void throwException(ERROR_TYPES ErrorType, const std::string &message, CScriptTokenizer::ScriptTokenPosition &Pos);
+	bool tokenizeFunctionBody(CScriptResult &execute, CScriptTokenDataFnc *Fnc); ///< a syntax error in a lazy body is thrown into the script
 private:
 	//////////////////////////////////////////////////////////////////////////
 	/// native Object-Constructors & prototype-functions
@@ -2247,6 +2901,16 @@ private:
 
 	void native_Iterator(const CFunctionsScopePtr &c, void *data);
 
+	void native_Map(const CFunctionsScopePtr &c, void *data);
+	void native_Map_prototype_get(const CFunctionsScopePtr &c, void *data);
+	void native_Map_prototype_set(const CFunctionsScopePtr &c, void *data);
+	void native_Map_prototype_has(const CFunctionsScopePtr &c, void *data);
+	void native_Map_prototype_delete(const CFunctionsScopePtr &c, void *data);
+	void native_Map_prototype_clear(const CFunctionsScopePtr &c, void *data);
+	void native_Map_prototype_size(const CFunctionsScopePtr &c, void *data);
+	void native_Map_prototype_forEach(const CFunctionsScopePtr &c, void *data);
+	void native_Map_prototype_iterator(const CFunctionsScopePtr &c, void *data);
+
 //	void native_Generator(const CFunctionsScopePtr &c, void *data);
 	void native_Generator_prototype_next(const CFunctionsScopePtr &c, void *data);
 
@@ -2270,6 +2934,37 @@ private:
 	void native_eval(const CFunctionsScopePtr &c, void *data);
 	void native_require(const CFunctionsScopePtr &c, void *data);
 	native_require_read_fnc native_require_read;
+	native_require_source_fnc native_require_source;
+	bool codeCache;
+	CScriptVarPtr executeScript(const CScript &Script, const std::string &Code="", const std::string &File="");
+	void throwCatchable(CScriptException *e);
+
+	/// the module registry of require - keyed by the resolved path
+	/** a module that uses exports or module.exports (CommonJS) is executed once, further requires return its exports.
+		Other files are executed in the scope of the caller on every require - only the compiled script is reused. */
+	struct MODULE {
+		MODULE() : mtime(0), size(-1), readTime(0), hash(0), commonJS(false), loading(false), visit(0) {}
+		CScript script;
+		int64_t mtime; ///< a file of the builtin reader is only read again if its time or size has changed
+		int64_t size;
+		int64_t readTime; ///< mtime has whole seconds -> a file modified in the second of the read is read again (and hashed)
+		uint64_t hash; ///< a read file is only compiled again if its hash has changed
+		bool commonJS;
+		bool loading; ///< a cyclic require gets the exports so far
+		uint32_t visit;
+		std::string file; ///< as given to require
+		CScriptVarPtr exports;
+		STRING_SET_t dependencies; ///< the modules required by the module
+	};
+	typedef std::map<std::string, MODULE> MODULES_t;
+	typedef MODULES_t::iterator MODULES_it;
+	MODULES_t modules;
+	STRING_VECTOR_t moduleStack; ///< the executing modules
+	uint32_t moduleVisit;
+	bool updateModule(MODULE &Module, const std::string &Path);
+	static CScript compileCached(const char *Code, size_t Size, const CScriptTokenDataPtr<CScriptTokenDataSource> &Source, const std::string &File, const std::string &CacheFile);
+	bool isBuiltinRequireReader();
+	bool dependenciesChanged(MODULE &Module);
 	void native_isNAN(const CFunctionsScopePtr &c, void *data);
 	void native_isFinite(const CFunctionsScopePtr &c, void *data);
 	void native_parseInt(const CFunctionsScopePtr &c, void *data);
@@ -2303,6 +2998,66 @@ public:
 };
 
 
+#ifdef HAVE_CXX11_VARIADIC_TEMPLATES
+//////////////////////////////////////////////////////////////////////////
+/// typed natives
+//////////////////////////////////////////////////////////////////////////
+
+/// boxes the result of a typed native
+template<typename R> struct CNativeResult { static CScriptVarPtr box(CTinyJS &Context, const R &r) { return Context.newScriptVar(r); } };
+template<> struct CNativeResult<bool> { static CScriptVarPtr box(CTinyJS &Context, bool r) { return Context.constScriptVar(r); } };
+template<> struct CNativeResult<CScriptVarPtr> { static CScriptVarPtr box(CTinyJS &, const CScriptVarPtr &r) { return r; } };
+
+template<typename R, typename... A> struct CNativeInvoker {
+	template<typename F, size_t... I>
+	static CScriptVarPtr call(CTinyJS &Context, const F &fnc, const CScriptVarPtr *Args, size_t Argc, CNativeIndexList<I...>) {
+		return CNativeResult<typename std::decay<R>::type>::box(Context, fnc(CNativeArgument<A>::get((I<Argc) ? Args[I] : Context.constScriptVar(Undefined))...));
+	}
+};
+template<typename... A> struct CNativeInvoker<void, A...> {
+	template<typename F, size_t... I>
+	static CScriptVarPtr call(CTinyJS &Context, const F &fnc, const CScriptVarPtr *Args, size_t Argc, CNativeIndexList<I...>) {
+		fnc(CNativeArgument<A>::get((I<Argc) ? Args[I] : Context.constScriptVar(Undefined))...);
+		return CScriptVarPtr();
+	}
+};
+
+template<typename R, typename... A> struct CNativeFunctionBinder {
+	R (*fnc)(A...);
+	R operator()(A... a) const { return fnc(a...); }
+	CScriptVarPtr operator()(CTinyJS &Context, const CScriptVarPtr *Args, size_t Argc) const {
+		return CNativeInvoker<R, A...>::call(Context, *this, Args, Argc, typename CNativeMakeIndexList<sizeof...(A)>::type());
+	}
+};
+template<class C, typename F, typename R, typename... A> struct CNativeMemberBinder {
+	C *classPtr;
+	F classFnc;
+	R operator()(A... a) const { return (classPtr->*classFnc)(a...); }
+	CScriptVarPtr operator()(CTinyJS &Context, const CScriptVarPtr *Args, size_t Argc) const {
+		return CNativeInvoker<R, A...>::call(Context, *this, Args, Argc, typename CNativeMakeIndexList<sizeof...(A)>::type());
+	}
+};
+
+template<typename R, typename... A>
+inline typename CNativeArguments<A...>::enabled CTinyJS::addNative(const std::string &funcDesc, R (*fnc)(A...), int LinkFlags) {
+	typedef CNativeFunctionBinder<R, A...> Binder;
+	Binder bind = { fnc };
+	return addNative(funcDesc, ::newScriptVarFunctionNativeTyped(this, bind), LinkFlags);
+}
+template<class C, typename R, typename... A>
+inline typename CNativeArguments<A...>::enabled CTinyJS::addNative(const std::string &funcDesc, C *class_ptr, R (C::*class_fnc)(A...), int LinkFlags) {
+	typedef CNativeMemberBinder<C, R (C::*)(A...), R, A...> Binder;
+	Binder bind = { class_ptr, class_fnc };
+	return addNative(funcDesc, ::newScriptVarFunctionNativeTyped(this, bind), LinkFlags);
+}
+template<class C, typename R, typename... A>
+inline typename CNativeArguments<A...>::enabled CTinyJS::addNative(const std::string &funcDesc, const C *class_ptr, R (C::*class_fnc)(A...) const, int LinkFlags) {
+	typedef CNativeMemberBinder<const C, R (C::*)(A...) const, R, A...> Binder;
+	Binder bind = { class_ptr, class_fnc };
+	return addNative(funcDesc, ::newScriptVarFunctionNativeTyped(this, bind), LinkFlags);
+}
+#endif /*HAVE_CXX11_VARIADIC_TEMPLATES*/
+
 //////////////////////////////////////////////////////////////////////////
 template<typename T>
 inline const CScriptVarPtr &CScriptVar::constScriptVar(T t) { return context->constScriptVar(t); }
@@ -99,41 +99,42 @@ namespace
 }
 #endif
 
-#define PARAMETER_TO_NUMBER(v,n) CNumber v = c->getArgument(n)->toNumber()
-#define RETURN_NAN_IS_NAN(v) do{ if(v.isNaN()) { c->setReturnVar(c->newScriptVar(v)); return; } }while(0)
-#define RETURN_NAN_IS_NAN_OR_INFINITY(v) do{ if(v.isNaN() || v.isInfinity()) { c->setReturnVar(c->newScriptVar(v)); return; } }while(0)
-#define RETURN_INFINITY_IS_INFINITY(v) do{ if(v.isInfinity()) { c->setReturnVar(c->newScriptVar(v)); return; } }while(0)
-#define RETURN_ZERO_IS_ZERO(v) do{ if(v.isZero()) { c->setReturnVar(c->newScriptVar(v)); return; } }while(0)
-#define RETURN(a)	do{ c->setReturnVar(c->newScriptVar(a)); return; }while(0)
-#define RETURNconst(a)	c->setReturnVar(c->constScriptVar(a))
+// the functions are numeric intrinsics (JSNumberIntrinsic) - the arguments are already numbers
+#define PARAMETER_TO_NUMBER(v,n) CNumber v = (size_t)(n)<Argc ? Args[n] : CNumber(NaN)
+#define RETURN_NAN_IS_NAN(v) do{ if(v.isNaN()) return v; }while(0)
+#define RETURN_NAN_IS_NAN_OR_INFINITY(v) do{ if(v.isNaN() || v.isInfinity()) return v; }while(0)
+#define RETURN_INFINITY_IS_INFINITY(v) do{ if(v.isInfinity()) return v; }while(0)
+#define RETURN_ZERO_IS_ZERO(v) do{ if(v.isZero()) return v; }while(0)
+#define RETURN(a)	return CNumber(a)
+#define RETURNconst(a)	return CNumber(a)
 
 //Math.abs(x) - returns absolute of given value
-static void scMathAbs(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); 
+static CNumber scMathAbs(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); 
 	RETURN(a.sign()<0?-a:a);
 }
 
 //Math.round(a) - returns nearest round of given value
-static void scMathRound(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a");
+static CNumber scMathRound(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0);
 	RETURN(a.round());
 }
 
 //Math.ceil(a) - returns nearest round of given value
-static void scMathCeil(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a);
+static CNumber scMathCeil(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a);
 	RETURN(a.ceil());
 }
 
 //Math.floor(a) - returns nearest round of given value
-static void scMathFloor(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); 
+static CNumber scMathFloor(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); 
 	RETURN(a.floor());
 }
 
 //Math.min(a,b) - returns minimum of two given values 
-static void scMathMin(const CFunctionsScopePtr &c, void *userdata) {
-	int length = c->getArgumentsLength();
+static CNumber scMathMin(const CNumber *Args, size_t Argc) {
+	int length = (int)Argc;
 	CNumber ret(InfinityPositive);
 	for(int i=0; i<length; i++)
 	{
@@ -144,8 +145,8 @@ static void scMathMin(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.max(a,b) - returns maximum of two given values  
-static void scMathMax(const CFunctionsScopePtr &c, void *userdata) {
-	int length = c->getArgumentsLength();
+static CNumber scMathMax(const CNumber *Args, size_t Argc) {
+	int length = (int)Argc;
 	CNumber ret(InfinityNegative);
 	for(int i=0; i<length; i++)
 	{
@@ -156,10 +157,10 @@ static void scMathMax(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.range(x,a,b) - returns value limited between two given values  
-static void scMathRange(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(x,"x"); RETURN_NAN_IS_NAN(x); 
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
-	PARAMETER_TO_NUMBER(b,"b"); RETURN_NAN_IS_NAN(b);
+static CNumber scMathRange(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(x,0); RETURN_NAN_IS_NAN(x); 
+	PARAMETER_TO_NUMBER(a,1); RETURN_NAN_IS_NAN(a); 
+	PARAMETER_TO_NUMBER(b,2); RETURN_NAN_IS_NAN(b);
 
 	if(a>b) RETURNconst(NaN);
 	if(x<a) RETURN(a);
@@ -168,11 +169,11 @@ static void scMathRange(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.sign(a) - returns sign of given value (-1==negative,0=zero,1=positive)
-static void scMathSign(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathSign(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN(a.isZero() ? 0 : a.sign());
 }
-static void scMathRandom(const CFunctionsScopePtr &c, void *) {
+static CNumber scMathRandom(const CNumber *Args, size_t Argc) {
 	static int inited=0;
 	if(!inited) {
 		inited = 1;
@@ -182,63 +183,63 @@ static void scMathRandom(const CFunctionsScopePtr &c, void *) {
 }
 
 //Math.toDegrees(a) - returns degree value of a given angle in radians
-static void scMathToDegrees(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a); 
+static CNumber scMathToDegrees(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a); 
 	RETURN( (180.0/k_PI)*a );
 }
 
 //Math.toRadians(a) - returns radians value of a given angle in degrees
-static void scMathToRadians(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a); 
+static CNumber scMathToRadians(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_INFINITY_IS_INFINITY(a); 
 	RETURN( (k_PI/180.0)*a );
 }
 
 //Math.sin(a) - returns trig. sine of given angle in radians
-static void scMathSin(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN_OR_INFINITY(a); RETURN_ZERO_IS_ZERO(a);
+static CNumber scMathSin(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN_OR_INFINITY(a); RETURN_ZERO_IS_ZERO(a);
 	RETURN( sin(a.toDouble()) );
 }
 
 //Math.asin(a) - returns trig. arcsine of given angle in radians
-static void scMathASin(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_ZERO_IS_ZERO(a);
+static CNumber scMathASin(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_ZERO_IS_ZERO(a);
 	if(abs(a)>1) RETURNconst(NaN);
 	RETURN( asin(a.toDouble()) );
 }
 
 //Math.cos(a) - returns trig. cosine of given angle in radians
-static void scMathCos(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN_OR_INFINITY(a); 
+static CNumber scMathCos(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN_OR_INFINITY(a); 
 	if(a.isZero()) RETURN(1);
 	RETURN( cos(a.toDouble()) );
 }
 
 //Math.acos(a) - returns trig. arccosine of given angle in radians
-static void scMathACos(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN_OR_INFINITY(a); 
+static CNumber scMathACos(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN_OR_INFINITY(a); 
 	if(abs(a)>1) RETURNconst(NaN);
 	else if(a==1) RETURN(0);
 	RETURN( acos(a.toDouble()) );
 }
 
 //Math.tan(a) - returns trig. tangent of given angle in radians
-static void scMathTan(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN_OR_INFINITY(a); RETURN_ZERO_IS_ZERO(a);
+static CNumber scMathTan(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN_OR_INFINITY(a); RETURN_ZERO_IS_ZERO(a);
 	RETURN( tan(a.toDouble()) );
 }
 
 //Math.atan(a) - returns trig. arctangent of given angle in radians
-static void scMathATan(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); RETURN_ZERO_IS_ZERO(a);
+static CNumber scMathATan(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); RETURN_ZERO_IS_ZERO(a);
 	int infinity=a.isInfinity();
 	if(infinity) RETURN(k_PI/(infinity*2));
 	RETURN( atan(a.toDouble()) );
 }
 
 //Math.atan2(a,b) - returns trig. arctangent of given angle in radians
-static void scMathATan2(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a);
-	PARAMETER_TO_NUMBER(b,"b"); RETURN_NAN_IS_NAN(b);
+static CNumber scMathATan2(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a);
+	PARAMETER_TO_NUMBER(b,1); RETURN_NAN_IS_NAN(b);
 	int sign_a = a.sign();
 	int sign_b = b.sign();
 	if(a.isZero())
@@ -260,47 +261,46 @@ static void scMathATan2(const CFunctionsScopePtr &c, void *userdata) {
 
 
 //Math.sinh(a) - returns trig. hyperbolic sine of given angle in radians
-static void scMathSinh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathSinh(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_ZERO_IS_ZERO(a);
-	if(abs(a)>1) RETURNconst(NaN);
 	RETURN( sinh(a.toDouble()) );
 }
 
 //Math.asinh(a) - returns trig. hyperbolic arcsine of given angle in radians
-static void scMathASinh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathASinh(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_INFINITY_IS_INFINITY(a);
 	RETURN_ZERO_IS_ZERO(a);
 	RETURN( asinh(a.toDouble()) );
 }
 
 //Math.cosh(a) - returns trig. hyperbolic cosine of given angle in radians
-static void scMathCosh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathCosh(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	if(a.isInfinity()) RETURNconst(InfinityPositive);
 	RETURN( cosh(a.toDouble()) );
 }
 
 //Math.acosh(a) - returns trig. hyperbolic arccosine of given angle in radians
-static void scMathACosh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathACosh(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_INFINITY_IS_INFINITY(a);
 	if(abs(a)<1) RETURNconst(NaN);
 	RETURN( acosh(a.toDouble()) );
 }
 
 //Math.tanh(a) - returns trig. hyperbolic tangent of given angle in radians
-static void scMathTanh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathTanh(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_ZERO_IS_ZERO(a);
 	if(a.isInfinity()) RETURN(a.sign());
 	RETURN( tanh(a.toDouble()) );
 }
 
 //Math.atanh(a) - returns trig. hyperbolic arctangent of given angle in radians
-static void scMathATanh(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathATanh(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_ZERO_IS_ZERO(a);
 	CNumber abs_a = abs(a);
 	if(abs_a > 1) RETURNconst(NaN);
@@ -309,8 +309,8 @@ static void scMathATanh(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.log(a) - returns natural logaritm (base E) of given value
-static void scMathLog(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathLog(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	if(a.isZero()) RETURNconst(InfinityNegative);
 	if(a.sign()<0) RETURNconst(NaN);
 	if(a.isInfinity()) RETURNconst(InfinityPositive);
@@ -318,8 +318,8 @@ static void scMathLog(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.log10(a) - returns logaritm(base 10) of given value
-static void scMathLog10(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathLog10(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	if(a.isZero()) RETURNconst(InfinityNegative);
 	if(a.sign()<0) RETURNconst(NaN);
 	if(a.isInfinity()) RETURNconst(InfinityPositive);
@@ -327,8 +327,8 @@ static void scMathLog10(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.exp(a) - returns e raised to the power of a given number
-static void scMathExp(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a);
+static CNumber scMathExp(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a);
 	if(a.isZero()) RETURN(1);
 	int a_i = a.isInfinity();
 	if(a_i>0) RETURNconst(InfinityPositive);
@@ -337,9 +337,9 @@ static void scMathExp(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.pow(a,b) - returns the result of a number raised to a power (a)^(b)
-static void scMathPow(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a");
-	PARAMETER_TO_NUMBER(b,"b"); RETURN_NAN_IS_NAN(b); 
+static CNumber scMathPow(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0);
+	PARAMETER_TO_NUMBER(b,1); RETURN_NAN_IS_NAN(b); 
 	if(b.isZero()) RETURN(1);
 	RETURN_NAN_IS_NAN(a);
 	if(b==1) RETURN(a);
@@ -371,14 +371,14 @@ static void scMathPow(const CFunctionsScopePtr &c, void *userdata) {
 }
 
 //Math.sqr(a) - returns square of given value
-static void scMathSqr(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a");
+static CNumber scMathSqr(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0);
 	RETURN( a*a );
 }
 
 //Math.sqrt(a) - returns square root of given value
-static void scMathSqrt(const CFunctionsScopePtr &c, void *userdata) {
-	PARAMETER_TO_NUMBER(a,"a"); RETURN_NAN_IS_NAN(a); 
+static CNumber scMathSqrt(const CNumber *Args, size_t Argc) {
+	PARAMETER_TO_NUMBER(a,0); RETURN_NAN_IS_NAN(a); 
 	RETURN_ZERO_IS_ZERO(a);
 	if(a.sign()<0) RETURNconst(NaN);
 	RETURN_INFINITY_IS_INFINITY(a); 
@@ -392,15 +392,15 @@ extern "C" void _registerMathFunctions(CTinyJS *tinyJS) {
 	 CScriptVarPtr Math = tinyJS->getRoot()->addChild("Math", tinyJS->newScriptVar(Object), SCRIPTVARLINK_CONSTANT);
 
 	 // --- Math and Trigonometry functions ---
-	 tinyJS->addNative("function Math.abs(a)", scMathAbs, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.round(a)", scMathRound, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.ceil(a)", scMathCeil, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.floor(a)", scMathFloor, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.min()", scMathMin, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.max()", scMathMax, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.range(x,a,b)", scMathRange, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.sign(a)", scMathSign, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.random(a)", scMathRandom, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.abs(a)", scMathAbs, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.round(a)", scMathRound, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.ceil(a)", scMathCeil, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.floor(a)", scMathFloor, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.min()", scMathMin, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.max()", scMathMax, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.range(x,a,b)", scMathRange, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.sign(a)", scMathSign, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.random(a)", scMathRandom, SCRIPTVARLINK_BUILDINDEFAULT);
 
 
 // atan2, ceil, floor, random, round, 
@@ -413,29 +413,29 @@ extern "C" void _registerMathFunctions(CTinyJS *tinyJS) {
 	 Math->addChild("SQRT2", tinyJS->newScriptVar(k_SQRT2), SCRIPTVARLINK_READONLY);
 	 Math->addChild("PI", tinyJS->newScriptVar(k_PI), SCRIPTVARLINK_READONLY);
 //    tinyJS->addNative("function Math.PI()", scMathPI, 0);
-	 tinyJS->addNative("function Math.toDegrees(a)", scMathToDegrees, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.toRadians(a)", scMathToRadians, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.sin(a)", scMathSin, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.asin(a)", scMathASin, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.cos(a)", scMathCos, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.acos(a)", scMathACos, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.tan(a)", scMathTan, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.atan(a)", scMathATan, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.atan2(a,b)", scMathATan2, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.sinh(a)", scMathSinh, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.asinh(a)", scMathASinh, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.cosh(a)", scMathCosh, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.acosh(a)", scMathACosh, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.tanh(a)", scMathTanh, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.atanh(a)", scMathATanh, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.toDegrees(a)", scMathToDegrees, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.toRadians(a)", scMathToRadians, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.sin(a)", scMathSin, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.asin(a)", scMathASin, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.cos(a)", scMathCos, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.acos(a)", scMathACos, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.tan(a)", scMathTan, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.atan(a)", scMathATan, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.atan2(a,b)", scMathATan2, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.sinh(a)", scMathSinh, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.asinh(a)", scMathASinh, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.cosh(a)", scMathCosh, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.acosh(a)", scMathACosh, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.tanh(a)", scMathTanh, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.atanh(a)", scMathATanh, SCRIPTVARLINK_BUILDINDEFAULT);
 		 
 	 Math->addChild("E", tinyJS->newScriptVar(k_E), SCRIPTVARLINK_READONLY);
-	 tinyJS->addNative("function Math.log(a)", scMathLog, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.log10(a)", scMathLog10, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.exp(a)", scMathExp, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.pow(a,b)", scMathPow, 0, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.log(a)", scMathLog, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.log10(a)", scMathLog10, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.exp(a)", scMathExp, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.pow(a,b)", scMathPow, SCRIPTVARLINK_BUILDINDEFAULT);
 	 
-	 tinyJS->addNative("function Math.sqr(a)", scMathSqr, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	 tinyJS->addNative("function Math.sqrt(a)", scMathSqrt, 0, SCRIPTVARLINK_BUILDINDEFAULT);    
+	 tinyJS->addNative("function Math.sqr(a)", scMathSqr, SCRIPTVARLINK_BUILDINDEFAULT);
+	 tinyJS->addNative("function Math.sqrt(a)", scMathSqrt, SCRIPTVARLINK_BUILDINDEFAULT);    
   
 }
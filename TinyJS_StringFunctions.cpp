@@ -44,47 +44,48 @@
 using namespace std;
 // ----------------------------------------------- Actual Functions
 
+// the functions use the fast calling convention (JSFastCallback)
+#define ARGUMENT(n) ((size_t)(n)<Argc ? Args[n] : Context.constScriptVar(Undefined))
+
 #define CheckObjectCoercible(var) do { \
 		if(var->isUndefined() || var->isNull())\
-			c->throwError(TypeError, "can't convert undefined to object");\
+			Context.throwNativeError(TypeError, "can't convert undefined to object");\
 	}while(0) 
 
-static string this2string(const CFunctionsScopePtr &c) {
-	CScriptVarPtr This = c->getArgument("this");
+static string this2string(CTinyJS &Context, const CScriptVarPtr &This) {
 	CheckObjectCoercible(This);
 	return This->toString();
 }
 
-static void scStringCharAt(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
-	int p = c->getArgument("pos")->toNumber().toInt32();
+static CScriptVarPtr scStringCharAt(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = this2string(Context, This);
+	int p = ARGUMENT(0)->toNumber().toInt32();
 	if (p>=0 && p<(int)str.length())
-		c->setReturnVar(c->newScriptVar(str.substr(p, 1)));
+		return Context.newScriptVar(str.substr(p, 1));
 	else
-		c->setReturnVar(c->newScriptVar(""));
+		return Context.newScriptVar("");
 }
 
-static void scStringCharCodeAt(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
-	int p = c->getArgument("pos")->toNumber().toInt32();
+static CScriptVarPtr scStringCharCodeAt(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = this2string(Context, This);
+	int p = ARGUMENT(0)->toNumber().toInt32();
 	if (p>=0 && p<(int)str.length())
-		c->setReturnVar(c->newScriptVar((unsigned char)str.at(p)));
+		return Context.newScriptVar((unsigned char)str.at(p));
 	else
-		c->setReturnVar(c->constScriptVar(NaN));
+		return Context.constScriptVar(NaN);
 }
 
-static void scStringConcat(const CFunctionsScopePtr &c, void *userdata) {
-	int length = c->getArgumentsLength();
-	string str = this2string(c);
-	for(int i=(int)userdata; i<length; i++)
-		str.append(c->getArgument(i)->toString());
-	c->setReturnVar(c->newScriptVar(str));
+static CScriptVarPtr scStringConcat(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = this2string(Context, This);
+	for(size_t i=0; i<Argc; i++)
+		str.append(Args[i]->toString());
+	return Context.newScriptVar(str);
 }
 
-static void scStringIndexOf(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	string search = c->getArgument("search")->toString();
-	CNumber pos_n = c->getArgument("pos")->toNumber();
+static CScriptVarPtr scStringIndexOf(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(Context, This);
+	string search = ARGUMENT(0)->toString();
+	CNumber pos_n = ARGUMENT(1)->toNumber();
 	string::size_type pos;
 	pos = (userdata) ? string::npos : 0;
 	if(pos_n.sign()<0) pos = 0;
@@ -92,21 +93,21 @@ static void scStringIndexOf(const CFunctionsScopePtr &c, void *userdata) {
 	else if(pos_n.isFinite()) pos = pos_n.toInt32();
 	string::size_type p = (userdata==0) ? str.find(search, pos) : str.rfind(search, pos);
 	int val = (p==string::npos) ? -1 : p;
-	c->setReturnVar(c->newScriptVar(val));
+	return Context.newScriptVar(val);
 }
 
-static void scStringLocaleCompare(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	string compareString = c->getArgument("compareString")->toString();
+static CScriptVarPtr scStringLocaleCompare(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(Context, This);
+	string compareString = ARGUMENT(0)->toString();
 	int val = 0;
 	if(str<compareString) val = -1;
 	else if(str>compareString) val = 1;
-	c->setReturnVar(c->newScriptVar(val));
+	return Context.newScriptVar(val);
 }
 
-static void scStringQuote(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	c->setReturnVar(c->newScriptVar(getJSString(str)));
+static CScriptVarPtr scStringQuote(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(Context, This);
+	return Context.newScriptVar(getJSString(str));
 }
 
 #ifndef NO_REGEXP
@@ -152,17 +153,16 @@ static bool string_search(const string &str, const string::const_iterator &searc
 // Access:    public static 
 // Returns:   bool true if regexp-param=RegExp-Object / other false
 // Qualifier:
-// Parameter: const CFunctionsScopePtr & c
-// Parameter: const string & regexp - parameter name of the regexp
+// Parameter: CTinyJS & Context
+// Parameter: const CScriptVarPtr & regexpVar - the regexp argument
 // Parameter: bool noUndefined - true an undefined regexp aims in "" else in "undefined"
-// Parameter: const string & flags - parameter name of the flags
+// Parameter: const CScriptVarPtr & flagVar - the flags argument or null
 // Parameter: string & substr - rgexp.source
 // Parameter: bool & global
 // Parameter: bool & ignoreCase
 // Parameter: bool & sticky
 //************************************
-static CScriptVarPtr getRegExpData(const CFunctionsScopePtr &c, const string &regexp, bool noUndefined, const char *flags_argument, string &substr, bool &global, bool &ignoreCase, bool &sticky) {
-	CScriptVarPtr regexpVar = c->getArgument(regexp);
+static CScriptVarPtr getRegExpData(CTinyJS &Context, const CScriptVarPtr &regexpVar, bool noUndefined, const CScriptVarPtr &flagVar, string &substr, bool &global, bool &ignoreCase, bool &sticky) {
 	if(regexpVar->isRegExp()) {
 #ifndef NO_REGEXP
 		CScriptVarRegExpPtr RegExp(regexpVar);
@@ -175,12 +175,11 @@ static CScriptVarPtr getRegExpData(const CFunctionsScopePtr &c, const string &re
 	} else {
 		substr.clear();
 		if(!noUndefined || !regexpVar->isUndefined()) substr = regexpVar->toString();
-		CScriptVarPtr flagVar;
-		if(flags_argument && (flagVar = c->getArgument(flags_argument)) && !flagVar->isUndefined()) {
+		if(flagVar && !flagVar->isUndefined()) {
 			string flags = flagVar->toString();
 			string::size_type pos = flags.find_first_not_of("gimy");
 			if(pos != string::npos) {
-				c->throwError(SyntaxError, string("invalid regular expression flag ")+flags[pos]);
+				Context.throwNativeError(SyntaxError, string("invalid regular expression flag ")+flags[pos]);
 			}
 			global = flags.find_first_of('g')!=string::npos;
 			ignoreCase = flags.find_first_of('i')!=string::npos;
@@ -191,12 +190,12 @@ static CScriptVarPtr getRegExpData(const CFunctionsScopePtr &c, const string &re
 	return CScriptVarPtr();
 }
 
-static void scStringReplace(const CFunctionsScopePtr &c, void *) {
-	const string str = this2string(c);
-	CScriptVarPtr newsubstrVar = c->getArgument("newsubstr");
+static CScriptVarPtr scStringReplace(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	const string str = this2string(Context, This);
+	CScriptVarPtr newsubstrVar = ARGUMENT(1);
 	string substr, ret_str;
 	bool global, ignoreCase, sticky;
-	bool isRegExp = getRegExpData(c, "substr", false, "flags", substr, global, ignoreCase, sticky);
+	bool isRegExp = getRegExpData(Context, ARGUMENT(0), false, ARGUMENT(2), substr, global, ignoreCase, sticky);
 	if(isRegExp && !newsubstrVar->isFunction()) {
 #ifndef NO_REGEXP
 		regex::flag_type flags = regex_constants::ECMAScript;
@@ -224,8 +223,8 @@ static void scStringReplace(const CFunctionsScopePtr &c, void *) {
 			do {
 				ret_str.append(search_begin, match_begin);
 				if(newsubstrVar->isFunction()) {
-					arguments.push_back(c->newScriptVar(string(match_begin, match_end)));
-					newsubstr = c->getContext()->callFunction(newsubstrVar, arguments, c)->toString();
+					arguments.push_back(Context.newScriptVar(string(match_begin, match_end)));
+					newsubstr = Context.callFunction(newsubstrVar, arguments, Context.getRoot())->toString(); // called like a plain function
 					arguments.pop_back();
 				}
 				ret_str.append(newsubstr);
@@ -245,28 +244,28 @@ static void scStringReplace(const CFunctionsScopePtr &c, void *) {
 		}
 		ret_str.append(search_begin, str.end());
 	}
-	c->setReturnVar(c->newScriptVar(ret_str));
+	return Context.newScriptVar(ret_str);
 }
 #ifndef NO_REGEXP
-static void scStringMatch(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
+static CScriptVarPtr scStringMatch(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = this2string(Context, This);
 
 	string flags="flags", substr, newsubstr, match;
 	bool global, ignoreCase, sticky;
-	CScriptVarRegExpPtr RegExp = getRegExpData(c, "regexp", true, "flags", substr, global, ignoreCase, sticky);
+	CScriptVarRegExpPtr RegExp = getRegExpData(Context, ARGUMENT(0), true, ARGUMENT(1), substr, global, ignoreCase, sticky);
 	if(!global) {
 		if(!RegExp)
-			RegExp = ::newScriptVar(c->getContext(), substr, flags);
+			RegExp = ::newScriptVar(&Context, substr, flags);
 		if(RegExp) {
 			try {
-				c->setReturnVar(RegExp->exec(str));
+				return RegExp->exec(str);
 			} catch(regex_error e) {
-				c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
+				Context.throwNativeError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
 			}
 		}
 	} else {
 		try { 
-			CScriptVarArrayPtr retVar = c->newScriptVar(Array);
+			CScriptVarArrayPtr retVar = Context.newScriptVar(Array);
 			int idx=0;
 			string::size_type offset=0;
 			global = global && substr.length();
@@ -274,7 +273,7 @@ static void scStringMatch(const CFunctionsScopePtr &c, void *) {
 			if(regex_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)) {
 				do {
 					offset = match_begin-str.begin();
-					retVar->addChild(int2string(idx++), c->newScriptVar(string(match_begin, match_end)));
+					retVar->addChild(int2string(idx++), Context.newScriptVar(string(match_begin, match_end)));
 #if 1 /* Fix from "vcmpeq" (see Issue 14) currently untested */
 					if (match_begin == match_end) {
 						if (search_begin != str.end())
@@ -290,84 +289,85 @@ static void scStringMatch(const CFunctionsScopePtr &c, void *) {
 				} while(global && regex_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end));
 			}
 			if(idx) {
-				retVar->addChild("input", c->newScriptVar(str));
-				retVar->addChild("index", c->newScriptVar((int)offset));
-				c->setReturnVar(retVar);
+				retVar->addChild("input", Context.newScriptVar(str));
+				retVar->addChild("index", Context.newScriptVar((int)offset));
+				return retVar;
 			} else
-				c->setReturnVar(c->constScriptVar(Null));
+				return Context.constScriptVar(Null);
 		} catch(regex_error e) {
-			c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
+			Context.throwNativeError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
 		}
 	}
+	return CScriptVarPtr();
 }
 #endif /* NO_REGEXP */
 
-static void scStringSearch(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
+static CScriptVarPtr scStringSearch(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(Context, This);
 
 	string substr;
 	bool global, ignoreCase, sticky;
-	getRegExpData(c, "regexp", true, "flags", substr, global, ignoreCase, sticky);
+	getRegExpData(Context, ARGUMENT(0), true, ARGUMENT(1), substr, global, ignoreCase, sticky);
 	string::const_iterator search_begin=str.begin(), match_begin, match_end;
 #ifndef NO_REGEXP
 	try { 
-		c->setReturnVar(c->newScriptVar(regex_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)?match_begin-search_begin:-1));
+		return Context.newScriptVar(regex_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)?match_begin-search_begin:-1);
 	} catch(regex_error e) {
-		c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
+		Context.throwNativeError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
 	}
+	return CScriptVarPtr();
 #else /* NO_REGEXP */
-	c->setReturnVar(c->newScriptVar(string_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)?match_begin-search_begin:-1));
+	return Context.newScriptVar(string_search(str, search_begin, substr, ignoreCase, sticky, match_begin, match_end)?match_begin-search_begin:-1);
 #endif /* NO_REGEXP */ 
 }
 
-static void scStringSlice(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	int length = c->getArgumentsLength()-((int)userdata & 1);
+static CScriptVarPtr scStringSlice(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(Context, This);
+	int length = (int)Argc;
 	bool slice = ((int)userdata & 2) == 0;
-	int start = c->getArgument("start")->toNumber().toInt32();
+	int start = ARGUMENT(0)->toNumber().toInt32();
 	int end = (int)str.size();
 	if(slice && start<0) start = str.size()+start;
 	if(length>1) {
-		end = c->getArgument("end")->toNumber().toInt32();
+		end = Args[1]->toNumber().toInt32();
 		if(slice && end<0) end = str.size()+end;
 	}
 	if(!slice && end < start) { end^=start; start^=end; end^=start; }
 	if(start<0) start = 0;
 	if(start>=(int)str.size()) 
-		c->setReturnVar(c->newScriptVar(""));
+		return Context.newScriptVar("");
 	else if(end <= start)
-		c->setReturnVar(c->newScriptVar(""));
+		return Context.newScriptVar("");
 	else
-		c->setReturnVar(c->newScriptVar(str.substr(start, end-start)));
+		return Context.newScriptVar(str.substr(start, end-start));
 }
 
-static void scStringSplit(const CFunctionsScopePtr &c, void *) {
-	const string str = this2string(c);
+static CScriptVarPtr scStringSplit(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	const string str = this2string(Context, This);
 
 	string seperator;
 	bool global, ignoreCase, sticky;
+	CScriptVarPtr sep_var = ARGUMENT(0);
+	CScriptVarPtr limit_var = ARGUMENT(1);
 #ifndef NO_REGEXP
-	CScriptVarRegExpPtr RegExp = getRegExpData(c, "separator", true, 0, seperator, global, ignoreCase, sticky);
+	CScriptVarRegExpPtr RegExp = getRegExpData(Context, sep_var, true, CScriptVarPtr(), seperator, global, ignoreCase, sticky);
 #else 
-	getRegExpData(c, "separator", true, 0, seperator, global, ignoreCase, sticky);
+	getRegExpData(Context, sep_var, true, CScriptVarPtr(), seperator, global, ignoreCase, sticky);
 #endif
 		
-	CScriptVarPtr sep_var = c->getArgument("separator");
-	CScriptVarPtr limit_var = c->getArgument("limit");
 	int limit = limit_var->isUndefined() ? 0x7fffffff : limit_var->toNumber().toInt32();
 
-	CScriptVarPtr result(newScriptVar(c->getContext(), Array));
-	c->setReturnVar(result);
+	CScriptVarPtr result(newScriptVar(&Context, Array));
 	if(limit == 0)
-		return;
+		return result;
 	else if(!str.size() || sep_var->isUndefined()) {
-		result->setArrayIndex(0, c->newScriptVar(str));
-		return;
+		result->setArrayIndex(0, Context.newScriptVar(str));
+		return result;
 	}
 	if(seperator.size() == 0) {
 		for(int i=0; i<min((int)str.size(), limit); ++i)
-			result->setArrayIndex(i, c->newScriptVar(str.substr(i,1)));
-		return;
+			result->setArrayIndex(i, Context.newScriptVar(str.substr(i,1)));
+		return result;
 	}
 	int length = 0;
 	string::const_iterator search_begin=str.begin(), match_begin, match_end;
@@ -381,60 +381,61 @@ static void scStringSplit(const CFunctionsScopePtr &c, void *) {
 			try { 
 				found = regex_search(str, search_begin, seperator, ignoreCase, sticky, match_begin, match_end, match);
 			} catch(regex_error e) {
-				c->throwError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
+				Context.throwNativeError(SyntaxError, string(e.what())+" - "+CScriptVarRegExp::ErrorStr(e.code()));
 			}
 		} else /* NO_REGEXP */
 #endif
 			found = string_search(str, search_begin, seperator, ignoreCase, sticky, match_begin, match_end);
 		string f;
 		if(found) {
-			result->setArrayIndex(length++, c->newScriptVar(string(search_begin, match_begin)));
+			result->setArrayIndex(length++, Context.newScriptVar(string(search_begin, match_begin)));
 			if(length>=limit) break;
 #ifndef NO_REGEXP
 			for(uint32_t i=1; i<match.size(); i++) {
 				if(match[i].matched) 
-					result->setArrayIndex(length++, c->newScriptVar(string(match[i].first, match[i].second)));
+					result->setArrayIndex(length++, Context.newScriptVar(string(match[i].first, match[i].second)));
 				else
-					result->setArrayIndex(length++, c->constScriptVar(Undefined));
+					result->setArrayIndex(length++, Context.constScriptVar(Undefined));
 				if(length>=limit) break;
 			}
 			if(length>=limit) break;
 #endif
 			search_begin = match_end;
 		} else {
-			result->setArrayIndex(length++, c->newScriptVar(string(search_begin,str.end())));
+			result->setArrayIndex(length++, Context.newScriptVar(string(search_begin,str.end())));
 			if(length>=limit) break;
 		}
 	}
+	return result;
 }
 
-static void scStringSubstr(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
-	int length = c->getArgumentsLength()-(int)userdata;
-	int start = c->getArgument("start")->toNumber().toInt32();
+static CScriptVarPtr scStringSubstr(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(Context, This);
+	int length = (int)Argc;
+	int start = ARGUMENT(0)->toNumber().toInt32();
 	if(start<0 || start>=(int)str.size()) 
-		c->setReturnVar(c->newScriptVar(""));
+		return Context.newScriptVar("");
 	else if(length>1) {
-		int length = c->getArgument("length")->toNumber().toInt32();
-		c->setReturnVar(c->newScriptVar(str.substr(start, length)));
+		int length = Args[1]->toNumber().toInt32();
+		return Context.newScriptVar(str.substr(start, length));
 	} else
-		c->setReturnVar(c->newScriptVar(str.substr(start)));
+		return Context.newScriptVar(str.substr(start));
 }
 
-static void scStringToLowerCase(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
+static CScriptVarPtr scStringToLowerCase(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = this2string(Context, This);
 	transform(str.begin(), str.end(), str.begin(), ::tolower);
-	c->setReturnVar(c->newScriptVar(str));
+	return Context.newScriptVar(str);
 }
 
-static void scStringToUpperCase(const CFunctionsScopePtr &c, void *) {
-	string str = this2string(c);
+static CScriptVarPtr scStringToUpperCase(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = this2string(Context, This);
 	transform(str.begin(), str.end(), str.begin(), ::toupper);
-	c->setReturnVar(c->newScriptVar(str));
+	return Context.newScriptVar(str);
 }
 
-static void scStringTrim(const CFunctionsScopePtr &c, void *userdata) {
-	string str = this2string(c);
+static CScriptVarPtr scStringTrim(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *userdata) {
+	string str = this2string(Context, This);
 	string::size_type start = 0;
 	string::size_type end = string::npos;
 	if((((int)userdata) & 2) == 0) {
@@ -445,25 +446,25 @@ static void scStringTrim(const CFunctionsScopePtr &c, void *userdata) {
 		end = str.find_last_not_of(" \t\r\n");
 		if(end != string::npos) end = 1+end-start;
 	}
-	c->setReturnVar(c->newScriptVar(str.substr(start, end)));
+	return Context.newScriptVar(str.substr(start, end));
 }
 
 
 
-static void scCharToInt(const CFunctionsScopePtr &c, void *) {
-	string str = c->getArgument("ch")->toString();;
+static CScriptVarPtr scCharToInt(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	string str = ARGUMENT(0)->toString();;
 	int val = 0;
 	if (str.length()>0)
 		val = (int)str.c_str()[0];
-	c->setReturnVar(c->newScriptVar(val));
+	return Context.newScriptVar(val);
 }
 
 
-static void scStringFromCharCode(const CFunctionsScopePtr &c, void *) {
+static CScriptVarPtr scStringFromCharCode(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
 	char str[2];
-	str[0] = c->getArgument("char")->toNumber().toInt32();
+	str[0] = ARGUMENT(0)->toNumber().toInt32();
 	str[1] = 0;
-	c->setReturnVar(c->newScriptVar(str));
+	return Context.newScriptVar(str);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -472,19 +473,17 @@ static void scStringFromCharCode(const CFunctionsScopePtr &c, void *) {
 
 #ifndef NO_REGEXP
 
-static void scRegExpTest(const CFunctionsScopePtr &c, void *) {
-	CScriptVarRegExpPtr This = c->getArgument("this");
-	if(This)
-		c->setReturnVar(This->exec(c->getArgument("str")->toString(), true));
-	else
-		c->throwError(TypeError, "Object is not a RegExp-Object in test(str)");
+static CScriptVarPtr scRegExpTest(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptVarRegExpPtr RegExp = This;
+	if(!RegExp)
+		Context.throwNativeError(TypeError, "Object is not a RegExp-Object in test(str)");
+	return RegExp->exec(ARGUMENT(0)->toString(), true);
 }
-static void scRegExpExec(const CFunctionsScopePtr &c, void *) {
-	CScriptVarRegExpPtr This = c->getArgument("this");
-	if(This)
-		c->setReturnVar(This->exec(c->getArgument("str")->toString()));
-	else
-		c->throwError(TypeError, "Object is not a RegExp-Object in exec(str)");
+static CScriptVarPtr scRegExpExec(CTinyJS &Context, const CScriptVarPtr &This, const CScriptVarPtr *Args, size_t Argc, void *) {
+	CScriptVarRegExpPtr RegExp = This;
+	if(!RegExp)
+		Context.throwNativeError(TypeError, "Object is not a RegExp-Object in exec(str)");
+	return RegExp->exec(ARGUMENT(0)->toString());
 }
 #endif /* NO_REGEXP */
 
@@ -500,7 +499,7 @@ extern "C" void _registerStringFunctions(CTinyJS *tinyJS) {
 	tinyJS->addNative("function String.charCodeAt(this,pos)", scStringCharCodeAt, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	// concat
 	tinyJS->addNative("function String.prototype.concat()", scStringConcat, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.concat(this)", scStringConcat, (void*)1, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function String.concat(this)", scStringConcat, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	// indexOf
 	tinyJS->addNative("function String.prototype.indexOf(search,pos)", scStringIndexOf, 0, SCRIPTVARLINK_BUILDINDEFAULT); // find the position of a string in a string, -1 if not
 	tinyJS->addNative("function String.indexOf(this,search,pos)", scStringIndexOf, 0, SCRIPTVARLINK_BUILDINDEFAULT); // find the position of a string in a string, -1 if not
@@ -526,16 +525,16 @@ extern "C" void _registerStringFunctions(CTinyJS *tinyJS) {
 	tinyJS->addNative("function String.search(this, regexp, flags)", scStringSearch, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	// slice
 	tinyJS->addNative("function String.prototype.slice(start,end)", scStringSlice, 0, SCRIPTVARLINK_BUILDINDEFAULT); // find the last position of a string in a string, -1 if not
-	tinyJS->addNative("function String.slice(this,start,end)", scStringSlice, (void*)1, SCRIPTVARLINK_BUILDINDEFAULT); // find the last position of a string in a string, -1 if not
+	tinyJS->addNative("function String.slice(this,start,end)", scStringSlice, 0, SCRIPTVARLINK_BUILDINDEFAULT); // find the last position of a string in a string, -1 if not
 	// split
 	tinyJS->addNative("function String.prototype.split(separator,limit)", scStringSplit, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	tinyJS->addNative("function String.split(this,separator,limit)", scStringSplit, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	// substr
 	tinyJS->addNative("function String.prototype.substr(start,length)", scStringSubstr, 0, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.substr(this,start,length)", scStringSubstr, (void*)1, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function String.substr(this,start,length)", scStringSubstr, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	// substring
 	tinyJS->addNative("function String.prototype.substring(start,end)", scStringSlice, (void*)2, SCRIPTVARLINK_BUILDINDEFAULT);
-	tinyJS->addNative("function String.substring(this,start,end)", scStringSlice, (void*)3, SCRIPTVARLINK_BUILDINDEFAULT);
+	tinyJS->addNative("function String.substring(this,start,end)", scStringSlice, (void*)2, SCRIPTVARLINK_BUILDINDEFAULT);
 	// toLowerCase toLocaleLowerCase currently the same function
 	tinyJS->addNative("function String.prototype.toLowerCase()", scStringToLowerCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
 	tinyJS->addNative("function String.toLowerCase(this)", scStringToLowerCase, 0, SCRIPTVARLINK_BUILDINDEFAULT);
@@ -0,0 +1,88 @@
+/*
+ * 42TinyJS
+ *
+ * code cache benchmark - the startup cost of a large library script
+ * tokenized from source and restored from a code cache image
+ *
+ * build with
+ *   make code_cache
+ * and run
+ *   ./code_cache [functions]
+ *
+ * The cache file library.js.tjsc is written to the current directory and removed again.
+ */
+
+#define WITH_TIME_LOGGER
+
+#include "../TinyJS.h"
+#include "../time_logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+
+// a library of small functions with loops, object literals, closures and try-blocks
+static std::string library(int functions) {
+	std::ostringstream code;
+	for(int i=0; i<functions; i++) {
+		code << "function lib" << i << "(list, options) {\n"
+			<< "	var config = { name: 'lib" << i << "', factor: " << i << ".5, tags: ['a', 'b', 'c'] };\n"
+			<< "	var sum = 0;\n"
+			<< "	for(var j = 0; j < list.length; j++) {\n"
+			<< "		if(list[j] > config.factor) sum += list[j] * 2; else sum -= 1;\n"
+			<< "	}\n"
+			<< "	try {\n"
+			<< "		return (function(v) { return v + sum; })(options[0]);\n"
+			<< "	} catch(e) {\n"
+			<< "		return \"error in \" + config.name + ': ' + e;\n"
+			<< "	}\n"
+			<< "}\n";
+	}
+	code << "var libraryReady = lib" << functions-1 << "([1, 2, 3], [10, 20]);\n";
+	return code.str();
+}
+
+int main(int argc, char **argv) {
+	int functions = argc > 1 ? atoi(argv[1]) : 2000;
+	if(functions < 1) functions = 1;
+	std::string code = library(functions);
+	printf("library: %d functions, %d KB\n", functions, (int)(code.size()/1024));
+	try {
+		TimeLoggerCreate(tokenize, "from source");
+		TimeLoggerStart(tokenize);
+		CScript compiled = CTinyJS::compile(code, "library.js");
+		TimeLoggerStop(tokenize);
+		TimeLoggerLogprint(tokenize);
+
+		std::string image;
+		compiled.save(image);
+		printf("image: %d KB\n", (int)(image.size()/1024));
+
+		TimeLoggerCreate(load, "from the image");
+		TimeLoggerStart(load);
+		CScript loaded = CScript::load(image.data(), image.size(), code, "library.js");
+		TimeLoggerStop(load);
+		TimeLoggerLogprint(load);
+		if(!loaded.isCompiled()) {
+			printf("the image was rejected\n");
+			return 1;
+		}
+
+		remove("library.js.tjsc");
+		CTinyJS::compileCached(code, "library.js"); // writes library.js.tjsc
+		TimeLoggerCreate(cached, "from library.js.tjsc");
+		TimeLoggerStart(cached);
+		CScript cached = CTinyJS::compileCached(code, "library.js");
+		TimeLoggerStop(cached);
+		TimeLoggerLogprint(cached);
+		remove("library.js.tjsc");
+
+		CTinyJS js;
+		js.execute(cached);
+		printf("library executed: %s\n", js.getRoot()->findChild("libraryReady")->toString().c_str());
+	} catch(CScriptException *e) {
+		printf("%s\n", e->toString().c_str());
+		delete e;
+		return 1;
+	}
+	return 0;
+}
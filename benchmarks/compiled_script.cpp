@@ -0,0 +1,112 @@
+/*
+ * 42TinyJS
+ *
+ * compiled script benchmark - the per-run cost of a rule script
+ * executed as source (tokenized on every run) and as a CScript (tokenized once)
+ *
+ * build with
+ *   make compiled_script
+ * and run
+ *   ./compiled_script [runs]
+ *
+ * With C++ threads the same CScript is also executed concurrently in
+ * one context per thread and the results are compared.
+ */
+
+#define WITH_TIME_LOGGER
+
+#include "../TinyJS.h"
+#include "../time_logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef HAVE_CXX_THREADS
+#	include <thread>
+#	include <vector>
+#endif
+
+static const char *rule =
+	"var limits = { low: 10, mid: 100, high: 1000 };\n"
+	"var tags = ['new', 'regular', 'vip', 'blocked'];\n"
+	"function classify(v) {\n"
+	"	if(v < limits.low) return 'low';\n"
+	"	if(v < limits.mid) return 'mid';\n"
+	"	return v < limits.high ? 'high' : 'extreme';\n"
+	"}\n"
+	"function score(v, tag) {\n"
+	"	var s = 0;\n"
+	"	for(var i = 0; i < 8; i++) s += (v * (i + 1)) % 7;\n"
+	"	switch(tag) {\n"
+	"		case 'vip': s *= 2; break;\n"
+	"		case 'blocked': s = 0; break;\n"
+	"		default: s += tag.length;\n"
+	"	}\n"
+	"	return s;\n"
+	"}\n"
+	"var tag = tags[input % tags.length];\n"
+	"output = classify(input) + ':' + tag + ':' + score(input, tag);\n";
+
+static std::string run(CTinyJS &js, int input, const CScript *script) {
+	js.getRoot()->addChildOrReplace("input", js.newScriptVar(input));
+	if(script)
+		js.execute(*script);
+	else
+		js.execute(rule, "rule.js");
+	return js.getRoot()->findChild("output")->toString();
+}
+
+#ifdef HAVE_CXX_THREADS
+static void runThread(const CScript *script, int runs, std::vector<std::string> *results) {
+	CTinyJS js;
+	for(int i=0; i<runs; i++)
+		(*results)[i] = run(js, i, script);
+}
+#endif
+
+int main(int argc, char **argv) {
+	int runs = argc > 1 ? atoi(argv[1]) : 2000;
+	if(runs < 1) runs = 1;
+	std::vector<std::string> expected(runs);
+	int errors = 0;
+	try {
+		{
+			CTinyJS js;
+			TimeLoggerCreate(source, "tokenized on every run");
+			for(int i=0; i<runs; i++) {
+				TimeLoggerHelper(source);
+				expected[i] = run(js, i, 0);
+			}
+		}
+		TimeLoggerCreate(compile, "once");
+		TimeLoggerStart(compile);
+		CScript script = CTinyJS::compile(rule, "rule.js");
+		TimeLoggerStop(compile);
+		TimeLoggerLogprint(compile);
+		{
+			CTinyJS js;
+			TimeLoggerCreate(compiled, "CScript");
+			for(int i=0; i<runs; i++) {
+				TimeLoggerHelper(compiled);
+				if(run(js, i, &script) != expected[i]) errors++;
+			}
+		}
+#ifdef HAVE_CXX_THREADS
+		enum { THREADS = 4 };
+		std::vector<std::vector<std::string> > results(THREADS, std::vector<std::string>(runs));
+		std::vector<std::thread> threads;
+		for(int t=0; t<THREADS; t++)
+			threads.push_back(std::thread(runThread, &script, runs, &results[t]));
+		for(int t=0; t<THREADS; t++) {
+			threads[t].join();
+			for(int i=0; i<runs; i++)
+				if(results[t][i] != expected[i]) errors++;
+		}
+		printf("%d threads executed the shared CScript %d times each\n", (int)THREADS, runs);
+#endif
+	} catch(CScriptException *e) {
+		printf("%s\n", e->toString().c_str());
+		delete e;
+		return 1;
+	}
+	printf("%d runs, %d mismatches\n", runs, errors);
+	return errors ? 1 : 0;
+}
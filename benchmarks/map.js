@@ -0,0 +1,16 @@
+// Map benchmark - compare with object_map.js
+//
+// builds a table of N string keys, looks every key up and removes every second one
+//
+// build run_tests with WITH_TIME_LOGGER defined and run
+//   ./run_tests benchmarks/map.js benchmarks/object_map.js
+// to get the time of each file
+
+var N = 20000;
+
+var m = new Map(), hits = 0;
+for(var i=0; i<N; i++) m.set("k"+i, i);
+for(var i=0; i<N; i++) if(m.has("k"+i)) hits += m.get("k"+i);
+for(var i=0; i<N; i+=2) m.delete("k"+i);
+
+result = hits == N*(N-1)/2 && m.size == N/2;
@@ -0,0 +1,16 @@
+// object-as-map benchmark - compare with map.js
+//
+// builds a table of N string keys, looks every key up and removes every second one
+//
+// build run_tests with WITH_TIME_LOGGER defined and run
+//   ./run_tests benchmarks/map.js benchmarks/object_map.js
+// to get the time of each file
+
+var N = 20000;
+
+var o = {}, hits = 0;
+for(var i=0; i<N; i++) o["k"+i] = i;
+for(var i=0; i<N; i++) if(o.hasOwnProperty("k"+i)) hits += o["k"+i];
+for(var i=0; i<N; i+=2) delete o["k"+i];
+
+result = hits == N*(N-1)/2 && Object.keys(o).length == N/2;
@@ -0,0 +1,75 @@
+/*
+ * 42TinyJS
+ *
+ * parallel compile benchmark - the load time of a bundle of independent
+ * library files compiled one after the other and on a pool of threads
+ *
+ * build with
+ *   make parallel_compile
+ * and run
+ *   ./parallel_compile [files] [threads]
+ *
+ * threads 0 (default) uses one thread per CPU.
+ */
+
+#define WITH_TIME_LOGGER
+
+#include "../TinyJS.h"
+#include "../time_logger.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sstream>
+
+// a library file with small functions, object literals, loops and closures
+static std::string library(int file) {
+	std::ostringstream code;
+	for(int i=0; i<300; i++) {
+		code << "function lib" << file << "_" << i << "(list, options) {\n"
+			<< "	var config = { name: 'lib" << i << "', factor: " << i << ".5, tags: ['a', 'b', 'c'] };\n"
+			<< "	var sum = 0;\n"
+			<< "	for(var j = 0; j < list.length; j++) {\n"
+			<< "		if(list[j] > options.limit) continue;\n"
+			<< "		sum += list[j] * config.factor;\n"
+			<< "	}\n"
+			<< "	return function(x) { return x + sum + config.tags.length; };\n"
+			<< "}\n";
+	}
+	code << "var loaded" << file << " = lib" << file << "_1([1, 2, 3], { limit: 2 })(1);\n";
+	return code.str();
+}
+
+int main(int argc, char **argv) {
+	int files = argc > 1 ? atoi(argv[1]) : 40;
+	int threads = argc > 2 ? atoi(argv[2]) : 0;
+	if(files < 1) files = 1;
+	STRING_VECTOR_t codes, names;
+	for(int i=0; i<files; i++) {
+		std::ostringstream name;
+		name << "lib" << i << ".js";
+		codes.push_back(library(i));
+		names.push_back(name.str());
+	}
+	try {
+		std::vector<CScript> serial, parallel;
+		TimeLoggerCreate(serialCompile, "one thread");
+		TimeLoggerStart(serialCompile);
+		CTinyJS::compile(codes, names, serial, 1);
+		TimeLoggerStop(serialCompile);
+		TimeLoggerLogprint(serialCompile);
+
+		TimeLoggerCreate(parallelCompile, "thread pool");
+		TimeLoggerStart(parallelCompile);
+		CTinyJS::compile(codes, names, parallel, threads);
+		TimeLoggerStop(parallelCompile);
+		TimeLoggerLogprint(parallelCompile);
+
+		CTinyJS js;
+		js.execute(parallel);
+		printf("%d files executed, loaded0 = %s\n", files, js.evaluate("loaded0").c_str());
+	} catch(CScriptException *e) {
+		printf("%s\n", e->toString().c_str());
+		delete e;
+		return 1;
+	}
+	return 0;
+}
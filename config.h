@@ -151,6 +151,7 @@
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 
 #	define HAVE_CXX11_RVALUE_REFERENCE 1
+#	define HAVE_CXX11_VARIADIC_TEMPLATES 1
 #	define MEMBER_DELETE =delete
 
 #	if !defined(NO_CXX_THREADS) && !defined(NO_THREADING)
@@ -166,6 +167,7 @@
 #		endif
 #	endif
 #	if _MSC_VER >= 1800
+#		define HAVE_CXX11_VARIADIC_TEMPLATES 1
 #		define define MEMBER_DELETE =delete
 #	endif
 #endif
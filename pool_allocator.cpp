@@ -217,9 +217,7 @@ public:
 };
 #define LOCK lock_help lock
 #endif
-void* fixed_size_allocator::alloc(size_t size, const char *for_class) {
-	TimeLoggerHelper(alloc);
-	LOCK;
+void *fixed_size_allocator::pool_alloc(size_t size, const char *for_class) {
 	if(!allocator_pool.allocator_pool) {
 		allocator_pool.allocator_pool = new allocator_pool_t();
 		allocator_pool.last_allocate_allocator = allocator_pool.last_free_allocator = 0;
@@ -235,9 +233,7 @@ void* fixed_size_allocator::alloc(size_t size, const char *for_class) {
 		}
 	}
 }
-void fixed_size_allocator::free(void *p, size_t size) {
-	TimeLoggerHelper(free);
-	LOCK;
+void fixed_size_allocator::pool_free(void *p, size_t size) {
 	if(!allocator_pool.allocator_pool) {
 		ASSERT(0/* free called but not allocator defined*/);
 		return;
@@ -256,3 +252,98 @@ void fixed_size_allocator::free(void *p, size_t size) {
 			ASSERT(0/* free called but not allocator defined*/);
 	}
 }
+
+#if defined(HAVE_CXX_THREADS) && (!defined(_MSC_VER) || _MSC_VER >= 1900)
+#	define HAVE_THREAD_CACHE
+#endif
+
+#ifdef HAVE_THREAD_CACHE
+//////////////////////////////////////////////////////////////////////////
+/// thread cache - each thread keeps some free objects of each small size
+/// most allocs and frees needs no lock - e.g. when many threads tokenize at the same time
+//////////////////////////////////////////////////////////////////////////
+
+enum {
+	THREAD_CACHE_SIZES	= 32,	// objects up to 31 pointers
+	THREAD_CACHE_MAX		= 64,	// max. cached objects per size
+	THREAD_CACHE_REFILL	= 16,	// objects taken from the pool with one lock
+};
+struct thread_cache_t {
+	void *head[THREAD_CACHE_SIZES];
+	size_t size[THREAD_CACHE_SIZES]; // a list holds objects of one size
+	int count[THREAD_CACHE_SIZES];
+	bool registered, disabled;
+};
+// a POD -> zero initialized and usable until the thread ends
+static thread_local thread_cache_t thread_cache;
+
+class thread_cache_flusher {
+public:
+	~thread_cache_flusher() { fixed_size_allocator::flushThreadCache(); thread_cache.disabled = true; }
+};
+static thread_local thread_cache_flusher thread_cache_flush;
+
+static inline int thread_cache_index(size_t size) {
+	size_t idx = size / sizeof(void*);
+	return idx < THREAD_CACHE_SIZES && !thread_cache.disabled ? int(idx) : -1;
+}
+static inline void thread_cache_push(int idx, void *p, size_t size) {
+	set_next(p, thread_cache.head[idx]);
+	thread_cache.head[idx] = p;
+	thread_cache.size[idx] = size;
+	thread_cache.count[idx]++;
+}
+#endif /*HAVE_THREAD_CACHE*/
+
+void fixed_size_allocator::flushThreadCache() {
+#ifdef HAVE_THREAD_CACHE
+	LOCK;
+	for(int i=0; i<THREAD_CACHE_SIZES; i++) {
+		while(void *p = thread_cache.head[i]) {
+			thread_cache.head[i] = get_next(p);
+			pool_free(p, thread_cache.size[i]);
+		}
+		thread_cache.count[i] = 0;
+	}
+#endif
+}
+
+void* fixed_size_allocator::alloc(size_t size, const char *for_class) {
+	TimeLoggerHelper(alloc);
+#ifdef HAVE_THREAD_CACHE
+	int idx = thread_cache_index(size);
+	if(idx >= 0 && (thread_cache.count[idx] == 0 || thread_cache.size[idx] == size)) {
+		if(!thread_cache.registered) {
+			thread_cache.registered = true;
+			(void)&thread_cache_flush; // flushes the cache at the end of the thread
+		}
+		if(void *p = thread_cache.head[idx]) {
+			thread_cache.head[idx] = get_next(p);
+			thread_cache.count[idx]--;
+			return p;
+		}
+		LOCK;
+		for(int i=1; i<THREAD_CACHE_REFILL; i++)
+			thread_cache_push(idx, pool_alloc(size, for_class), size);
+		return pool_alloc(size, for_class);
+	}
+#endif
+	LOCK;
+	return pool_alloc(size, for_class);
+}
+void fixed_size_allocator::free(void *p, size_t size) {
+	TimeLoggerHelper(free);
+#ifdef HAVE_THREAD_CACHE
+	int idx = thread_cache_index(size);
+	if(idx >= 0 && thread_cache.count[idx] < THREAD_CACHE_MAX && (thread_cache.count[idx] == 0 || thread_cache.size[idx] == size)) {
+		if(!thread_cache.registered) {
+			thread_cache.registered = true;
+			(void)&thread_cache_flush;
+		}
+		thread_cache_push(idx, p, size);
+		return;
+	}
+#endif
+	LOCK;
+	pool_free(p, size);
+}
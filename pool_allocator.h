@@ -55,6 +55,7 @@ public:
 	~fixed_size_allocator();
 	static void *alloc(size_t,const char* for_class=0);
 	static void free(void *, size_t);
+	static void flushThreadCache(); ///< returns the objects cached by the calling thread to the pool (done at the end of each thread)
 	size_t objectSize() { return object_size; }
 #ifndef NO_THREADING
 	static CScriptMutex locker;
@@ -65,6 +66,8 @@ private:
 	fixed_size_allocator& operator=(const fixed_size_allocator&);
 	void *_alloc(size_t);
 	bool _free(void* p, size_t);
+	static void *pool_alloc(size_t size, const char *for_class); // needs the lock
+	static void pool_free(void *p, size_t size); // needs the lock
 	size_t num_objects;
 	size_t object_size;
 	void *head_of_free_list;
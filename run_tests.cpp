@@ -68,6 +68,8 @@
 #include <sstream>
 #include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <map>
 
 //#define WITH_TIME_LOGGER
 //#define INSANE_MEMORY_DEBUG
@@ -239,38 +241,65 @@ public:
 void js_print(const CFunctionsScopePtr &v, void *) {
 	printf("> %s\n", v->getArgument("text")->toString().c_str());
 }
-bool run_test(const char *filename) {
-  printf("TEST %s ", filename);
-  struct stat results;
-  if (!stat(filename, &results) == 0) {
-    printf("Cannot stat file! '%s'\n", filename);
-    return false;
-  }
-  int size = results.st_size;
-  FILE *file = fopen( filename, "rb" );
-  /* if we open as text, the number of bytes read may be > the size we read */
-  if( !file ) {
-     printf("Unable to open file! '%s'\n", filename);
-     return false;
-  }
-  char *buffer = new char[size+1];
-  long actualRead = fread(buffer,1,size,file);
-  buffer[actualRead]=0;
-  buffer[size]=0;
-  fclose(file);
+#ifdef HAVE_CXX11_VARIADIC_TEMPLATES
+// typed natives (see tests/42tests/test016.js)
+static double js_typedMulAdd(double a, int32_t b, uint32_t c) { return a*b+c; }
+static std::string js_typedRepeat(const std::string &str, int32_t count) {
+	std::string ret;
+	while(count-- > 0) ret.append(str);
+	return ret;
+}
+static bool js_typedIsUndefined(const CScriptVarPtr &var) { return var->isUndefined(); }
+class js_typedCounter {
+public:
+	js_typedCounter() : count(0) {}
+	int32_t add(int32_t n) { return count += n; }
+	void reset() { count = 0; }
+	bool isOdd() const { return (count & 1) != 0; }
+private:
+	int32_t count;
+};
+#endif
+static bool run_compiled = false; // -c execute the tests as compiled scripts (CScript)
+static bool run_cached = false; // -C execute the tests and the required files from the code cache (<file>.tjsc)
+static bool run_parallel = false; // -p compile all tests concurrently before executing them
+static bool verify_folding = false; // -f execute the tests with and without constant folding and compare the results
+static std::map<std::string, CScript> precompiled;
+// Symbols receives the variables after a failed run (or all runs with -f)
+static bool execute_test(const char *filename, CScriptSource *source, std::string &symbols) {
+  const char *buffer = source->data();
 
   CTinyJS s;
   s.addNative("function print(text)", &js_print, 0);
+#ifdef HAVE_CXX11_VARIADIC_TEMPLATES
+  js_typedCounter counter;
+  s.addNative("function typedMulAdd(a,b,c)", js_typedMulAdd);
+  s.addNative("function typedRepeat(str,count)", js_typedRepeat);
+  s.addNative("function typedIsUndefined(v)", js_typedIsUndefined);
+  s.addNative("function typedCounterAdd(n)", &counter, &js_typedCounter::add);
+  s.addNative("function typedCounterReset()", &counter, &js_typedCounter::reset);
+  s.addNative("function typedCounterIsOdd()", (const js_typedCounter*)&counter, &js_typedCounter::isOdd);
+#endif
 
 //  registerFunctions(&s);
 //  registerMathFunctions(&s);
 //  registerStringFunctions(&s);
   s.getRoot()->addChild("result", s.newScriptVar(0));
+  s.setCodeCache(run_cached);
 #ifdef WITH_TIME_LOGGER
   TimeLoggerCreate(Test, true, filename);
 #endif
   try {
-    s.execute(buffer, filename);
+    if(precompiled.count(filename)) {
+      s.execute(precompiled[filename]);
+    } else if(run_cached) {
+      CScript script = CTinyJS::compileCached(buffer, source->size(), filename);
+      s.execute(script);
+    } else if(run_compiled) {
+      CScript script = CTinyJS::compile(buffer, filename);
+      s.execute(script);
+    } else
+      s.execute(buffer, filename);
   } catch (CScriptException *e) {
     printf("%s\n", e->toString().c_str());
 	delete e;
@@ -279,26 +308,57 @@ bool run_test(const char *filename) {
 #ifdef WITH_TIME_LOGGER
   TimeLoggerLogprint(Test);
 #endif
+  if(!pass || verify_folding)
+    symbols = s.getRoot()->CScriptVar::getParsableString();
+  return pass;
+}
+static void write_symbols(const char *filename, const char *suffix, const std::string &symbols) {
+  std::string fn = std::string(filename) + suffix;
+  FILE *f = fopen(fn.c_str(), "wt");
+  if (f) {
+    fprintf(f, "%s", symbols.c_str());
+    fclose(f);
+  }
+}
+bool run_test(const char *filename) {
+  printf("TEST %s ", filename);
+  int error;
+  CScriptSource *source = CScriptSource::open(filename, error); // the file is mapped - not copied
+  if( !source ) {
+     printf("Unable to open file! '%s' (Error=%d)\n", filename, error);
+     return false;
+  }
+  std::string symbols;
+  bool pass;
+  if(verify_folding) {
+    std::string unfolded;
+    CScriptTokenizer::constantFolding = false;
+    bool unfolded_pass = execute_test(filename, source, unfolded);
+    CScriptTokenizer::constantFolding = true;
+    pass = execute_test(filename, source, symbols);
+    if(pass != unfolded_pass || symbols != unfolded) {
+      std::string control; // a second unfolded run - e.g. Math.random() differs on every run
+      CScriptTokenizer::constantFolding = false;
+      execute_test(filename, source, control);
+      CScriptTokenizer::constantFolding = true;
+      if(control == unfolded) {
+        write_symbols(filename, ".unfolded.txt", unfolded);
+        printf("FOLDING MISMATCH - ");
+        pass = false;
+      } else
+        printf("(not deterministic) ");
+    }
+  } else
+    pass = execute_test(filename, source, symbols);
 
   if (pass)
     printf("PASS\n");
   else {
-	 char fn[64];
-    sprintf(fn, "%s.fail.txt", filename);
-
-//	 logging is currently deactivated because stack-overflow by recursive vars
-    FILE *f = fopen(fn, "wt");
-    if (f) {
-		 
-      std::string symbols = s.getRoot()->CScriptVar::getParsableString();
-      fprintf(f, "%s", symbols.c_str());
-      fclose(f);
-    }
-
-	 printf("FAIL - symbols written to %s\n", fn);
+    write_symbols(filename, ".fail.txt", symbols);
+	 printf("FAIL - symbols written to %s.fail.txt\n", filename);
   }
 
-  delete[] buffer;
+  delete source;
   return pass;
 }
 
@@ -312,12 +372,27 @@ int main(int argc, char **argv)
   printf("   ./run_tests [-k] tests/test001.js [tests/42tests/test002.js]   : run tests\n");
   printf("   ./run_tests [-k]                      : run all tests\n");
   printf("   -k needs press enter at the end of runs\n");
+  printf("   -c compiles the tests to a CScript before executing\n");
+  printf("   -C like -c but uses the code cache (<file>.tjsc) also for require()\n");
+  printf("   -l tokenizes the function bodies on their first call\n");
+  printf("   -p compiles all tests concurrently before executing them\n");
+  printf("   -f executes the tests with and without constant folding and compares the variables\n");
   int arg_num = 1;
   bool runs = false;
   for(; arg_num<argc; arg_num++) {
     if(argv[arg_num][0] == '-') {
       if(strcmp(argv[arg_num], "-k")==0)
 			end.active = true;
+      else if(strcmp(argv[arg_num], "-c")==0)
+			run_compiled = true;
+      else if(strcmp(argv[arg_num], "-C")==0)
+			run_cached = true;
+      else if(strcmp(argv[arg_num], "-l")==0)
+			CScriptTokenizer::lazyFunctions = true;
+      else if(strcmp(argv[arg_num], "-p")==0)
+			run_parallel = true;
+      else if(strcmp(argv[arg_num], "-f")==0)
+			verify_folding = true;
 	 } else {
 		run_test(argv[arg_num]);
 		runs=true;
@@ -329,31 +404,56 @@ int main(int argc, char **argv)
 
   int count = 0;
   int passed = 0;
-  const char *mask[] = {"tests/test%03d%s.js", "tests/42tests/test%03d%s.js"};
+  const char *prefix[] = {"tests/test", "tests/42tests/test"};
 #ifdef WITH_TIME_LOGGER
   TimeLoggerCreate(Tests, true);
 #endif
+  STRING_VECTOR_t files;
   for(int js42 = 0; js42<2; js42++) {
     int test_num = 1;
     while (test_num<1000) {
-      char fn[32];
-      sprintf(fn, mask[js42], test_num, ".42");
+      char num[4];
+      sprintf(num, "%03d", test_num); // test_num < 1000
+      std::string fn = std::string(prefix[js42]) + num + ".42.js";
       // check if the file exists - if not, assume we're at the end of our tests
-      FILE *f = fopen(fn,"r");
+      FILE *f = fopen(fn.c_str(),"r");
       if (!f) {
-        sprintf(fn, mask[js42], test_num, "");
-        f = fopen(fn,"r");
+        fn = std::string(prefix[js42]) + num + ".js";
+        f = fopen(fn.c_str(),"r");
         if(!f) break;
       }
       fclose(f);
-
-      if (run_test(fn))
-        passed++;
-        count++;
-        test_num++;
+      files.push_back(fn);
+      test_num++;
     }
   }
+  if(verify_folding) // the code cache and the precompiled scripts don't know the folding mode
+    run_cached = run_parallel = false;
+  if(run_parallel) {
+    STRING_VECTOR_t codes;
+    for(STRING_VECTOR_t::iterator it=files.begin(); it!=files.end(); ++it) {
+      std::ifstream in(it->c_str(), std::ios::in | std::ios::binary);
+      std::ostringstream code;
+      code << in.rdbuf();
+      codes.push_back(code.str());
+    }
+    std::vector<CScript> scripts;
+    try {
+      CTinyJS::compile(codes, files, scripts);
+      for(size_t i=0; i<files.size(); i++)
+        precompiled[files[i]] = scripts[i];
+    } catch (CScriptException *e) { // the tests are compiled one by one
+      printf("%s\n", e->toString().c_str());
+      delete e;
+    }
+  }
+  for(STRING_VECTOR_t::iterator it=files.begin(); it!=files.end(); ++it) {
+    if (run_test(it->c_str()))
+      passed++;
+    count++;
+  }
   printf("Done. %d tests, %d pass, %d fail\n", count, passed, count-passed);
+  precompiled.clear(); // before the pool allocator is destroyed
 #ifdef WITH_TIME_LOGGER
   TimeLoggerLogprint(Tests);
 #endif
@@ -0,0 +1,42 @@
+// Map, Set, WeakMap, WeakSet
+
+var o = {}, f = function() {};
+var m = new Map([["a", 1], [2, "two"]]);
+m.set(o, "object").set(NaN, "nan").set(-0, "zero");
+
+var r1 = m.size == 5 && m.get("a") == 1 && m.get(2) == "two" && m.get("2") === undefined &&
+	m.get(o) == "object" && m.get({}) === undefined && m.get(NaN) == "nan" && m.get(0) == "zero" &&
+	m.has(o) && !m.has(f);
+
+var order = [];
+m.delete("a");
+m.set("a", 3);
+m.forEach(function(v, k, map) { order[order.length] = typeof k == "object" ? "o" : String(k); });
+var r2 = order.join(",") == "2,o,NaN,0,a" && m.size == 5;
+
+var keys = [];
+for(var k in m) keys[keys.length] = k;
+var values = [];
+for each(var e in m) values[values.length] = e[1];
+var r3 = keys.length == 5 && keys[0] == 2 && values[3] == "zero";
+
+var s = new Set([1, 2, 2, "1", 1]);
+s.add(3);
+var items = [];
+for each(var v in s) items[items.length] = v;
+var r4 = s.size == 4 && items.join(",") == "1,2,1,3" && s.has("1") && !s.has("3");
+s.clear();
+var r5 = s.size == 0 && Object.prototype.toString.call(m) == "[object Map]";
+
+var wm = new WeakMap(), ws = new WeakSet();
+wm.set(o, 1);
+ws.add(f);
+var r6 = wm.get(o) == 1 && wm.has(o) && !wm.has(f) && ws.has(f) && wm.delete(o) && !wm.has(o);
+try { wm.set("key", 1); r6 = false; } catch(e) { r6 = r6 && e instanceof TypeError; }
+
+// iterating while deleting
+var d = new Map([[1,1],[2,2],[3,3],[4,4]]), seen = 0;
+for each(var e in d) { d.delete(e[0]+1); seen++; }
+var r7 = seen == 2 && d.size == 2;
+
+result = r1 && r2 && r3 && r4 && r5 && r6 && r7;
@@ -0,0 +1,29 @@
+// for-in / Object.keys enumeration order, prototype chain and changes while enumerating
+
+var a = [];
+for(var i=0; i<12; i++) a[i] = i;
+var s = "";
+for(var k in a) s += k + ",";
+var r1 = s == "0,1,2,3,4,5,6,7,8,9,10,11," && Object.keys(a).length == 12 && Object.keys(a)[10] == "10";
+
+var o = Object.create({ inherited:3, shadow:4 }), names = "", sum = 0;
+o.own = 1;
+o.shadow = 2;
+for(var k in o) names += k + ",";
+for each(var v in o) sum += v;
+var r2 = names == "own,shadow,inherited," && sum == 6 && Object.keys(o).join(",") == "own,shadow";
+
+var x = { a:1, b:2, c:3, d:4 }, seen = "";
+for(var k in x) {
+	seen += k;
+	if(k == "a") { delete x.b; x.aa = 5; }
+}
+var r3 = seen == "aaacd";
+
+var str = new String("ab");
+str.foo = 1;
+seen = "";
+for(var k in str) seen += k;
+var r4 = seen == "01foo";
+
+result = r1 && r2 && r3 && r4;
@@ -0,0 +1,42 @@
+// for-in / for-each over arrays, strings, generators and user defined iterators
+
+var a = [1, 2, 3], sum = 0;
+for each(var v in a) sum += v;
+for(var v of a) sum += v;
+var s = "";
+for each(var c in "abc") s += c;
+var r1 = sum == 12 && s == "abc";
+
+function gen(n) { for(var i=0; i<n; i++) yield i; }
+var g = "";
+for(var v in gen(4)) g += v;
+var r2 = g == "0123";
+
+function thrower() { yield 1; throw "oops"; }
+var caught = "";
+try { for(var v in thrower()) caught += v; } catch(e) { caught += e; }
+var r3 = caught == "1oops";
+
+var counter = { __iterator__: function() {
+	var i = 0;
+	return { next: function() { if(i >= 3) throw StopIteration; return i++; } };
+} };
+var n = "";
+for(var v in counter) n += v;
+var r4 = n == "012";
+
+var pairs = "";
+for(var [k, v] in Iterator({ x:1, y:2 })) pairs += k + v;
+var r5 = pairs == "x1y2";
+
+// a replaced next of a builtin iterator is called
+var it = Iterator({ a:1, b:2 }, true), i = 0;
+it.next = function() { if(i++ >= 2) throw StopIteration; return "n"; };
+var replaced = "";
+for(var v in it) replaced += v;
+var other = Iterator({ x:1 }, true), it2 = Iterator({ a:1, b:2 }, true);
+it2.next = other.next;
+for(var v in it2) replaced += v;
+var r6 = replaced == "nnx";
+
+result = r1 && r2 && r3 && r4 && r5 && r6;
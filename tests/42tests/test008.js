@@ -0,0 +1,22 @@
+// object and array literals (boilerplate)
+
+var log = "";
+function f(x) { log += x; return x; }
+function make(i) { return { b:f("b"), a:1, c:"str", a:f("a"), 10:true, 2:null, i:i }; }
+var o1 = make(1), o2 = make(2);
+var r1 = log == "baba" && o1.a == "a" && o1.b == "b" && o1.c == "str" && o1[10] === true && o1[2] === null &&
+	o1.i == 1 && o2.i == 2 && Object.keys(o1).join(",") == "a,b,c,i,2,10";
+o1.c = "changed";
+var r2 = o2.c == "str";
+
+function arr(x) { return [1, x, , "s", [x]]; }
+var a1 = arr(1), a2 = arr(2);
+var r3 = a1.length == 5 && a1[1] == 1 && a2[1] == 2 && a1[2] === undefined && a1[4][0] == 1 && a2[4][0] == 2 && a1[4] != a2[4];
+
+var p = { __proto__: { inherited:3 }, own:1 };
+var r4 = p.inherited == 3 && p.own == 1;
+
+var g = { get x() { return 5; }, y:1 };
+var r5 = g.x == 5 && g.y == 1;
+
+result = r1 && r2 && r3 && r4 && r5;
@@ -0,0 +1,20 @@
+// number and string literals share one prebuilt immutable Var per token
+
+function f() {
+	var s = "abc", n = 5;
+	s.foo = 1; s.length = 7; n.x = 3; n++; s += "d";
+	return [s, s.foo, s.length, n, n.x, "abc".length, 1.5 + 1];
+}
+var a = f(), b = f();
+var r1 = a[0] == "abcd" && a[1] === undefined && a[2] == 4 && a[3] == 6 && a[4] === undefined && a[5] == 3 && a[6] == 2.5 &&
+	a.join(",") == b.join(",");
+
+var sum = 0, str = "";
+for (var i = 0; i < 5; i++) { sum = sum + 2; str = str + "x"; }
+var r2 = sum == 10 && str == "xxxxx" && "x".length == 1;
+
+var o = { k:"v", n:0.25 };
+o.k += "w"; o.n *= 2;
+var r3 = o.k == "vw" && o.n == 0.5 && { k:"v" }.k == "v";
+
+result = r1 && r2 && r3;
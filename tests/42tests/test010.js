@@ -0,0 +1,9 @@
+// arguments and branches that are not executed are skipped in one step
+
+function g(){ throw 1; }
+function f(){ return 7; }
+var r = 0;
+try { var x = f(g(), 2, f(3)) + 1; } catch(e) { r = e; }
+try { var y = new Object(1, g(), (2,3)); } catch(e) { r += e; }
+var z = 0 && f(1, 2, f(3));
+result = r == 2 && z === 0 && f(1,2) == 7;
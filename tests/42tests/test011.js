@@ -0,0 +1,25 @@
+// hoisted vars, consts, lets and functions (scope templates)
+
+function f(x) {
+	var r = [typeof g, typeof v, v, x];
+	var v = 1;
+	function g() { return v; }
+	function x() { return "fnc"; }
+	{
+		let l = 2;
+		r[r.length] = l + g();
+	}
+	return r;
+}
+var a = f(5), b = f(6);
+var r1 = a[0] == "function" && a[1] == "undefined" && a[2] === undefined && typeof a[3] == "function" && a[4] == 3;
+var r2 = b.join(",") == a.join(",");
+
+var closures = [];
+for (var i = 0; i < 3; i++) {
+	let j = i;
+	closures[i] = function() { return j; };
+}
+var r3 = closures[0]() == 0 && closures[2]() == 2;
+
+result = r1 && r2 && r3;
@@ -0,0 +1,23 @@
+// let-scopes of blocks are reused when nothing captured them
+
+var seen = "", sum = 0;
+for (var i = 0; i < 4; i++) {
+	let x;
+	seen += typeof x;
+	x = i;
+	let y = x * 2;
+	sum += y;
+}
+var r1 = seen == "undefinedundefinedundefinedundefined" && sum == 12;
+
+var fs = [];
+for (var j = 0; j < 3; j++) {
+	let k = j;
+	if (j != 1) fs[fs.length] = function() { return k; };
+}
+var r2 = fs.length == 2 && fs[0]() == 0 && fs[1]() == 2;
+
+function rec(n) { let v = n; if (n > 0) rec(n - 1); return v; }
+var r3 = rec(5) == 5;
+
+result = r1 && r2 && r3;
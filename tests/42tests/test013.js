@@ -0,0 +1,60 @@
+// closures keep only the variables they use - the captured variables are shared
+
+function counter() {
+	var count = 0, unused = { big: "data" };
+	return { inc: function() { return ++count; }, get: function() { return count; }, set: function(v) { count = v; } };
+}
+var c = counter();
+c.inc(); c.inc();
+var r1 = c.get() == 2;
+c.set(10);
+var r2 = c.inc() == 11 && c.get() == 11;
+
+function outer() {
+	var a = 1;
+	function middle() {
+		var b = 2;
+		return function() { return a + b; };
+	}
+	var f = middle();
+	a = 5;
+	return f;
+}
+var r3 = outer()() == 7;
+
+var fs = [];
+for (var i = 0; i < 3; i++) { let k = i; fs[fs.length] = function() { return k; }; }
+var r4 = fs[0]() == 0 && fs[1]() == 1 && fs[2]() == 2;
+
+function hoisted() {
+	function get() { return later; }
+	var later = "ok";
+	return get();
+}
+var r5 = hoisted() == "ok";
+
+function withEval() {
+	var x = 3;
+	return function(code) { return eval(code); };
+}
+var r6 = withEval()("x * 2") == 6;
+
+function withScope() {
+	var o = { p: 4 };
+	with (o) { return function() { return p; }; }
+}
+var r7 = withScope()() == 4;
+
+function Box(v) { this.v = v; this.get = x => this.v; }
+var box = new Box(8);
+var r8 = box.get() == 8;
+var obj = { v: 9, m: function() { var a = x => this.v; return a(); } };
+var r10 = obj.m() == 9;
+
+var g = 1;
+function useGlobal() { return function() { return g; }; }
+var fg = useGlobal();
+g = 2;
+var r11 = fg() == 2;
+
+result = r1 && r2 && r3 && r4 && r5 && r6 && r7 && r8 && r10 && r11;
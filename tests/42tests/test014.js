@@ -0,0 +1,33 @@
+// call-sites remember their last function - polymorphic sites, rebinding and parameter kinds
+
+function add(a, b) { return a + b; }
+function mul(a, b) { return a * b; }
+function def(a, b = 10) { return a + b; }
+function count() { return arguments.length; }
+function missing(a, b) { return typeof b; }
+
+var fns = [add, mul, def, add.bind(null, 100)];
+var r = [];
+for (var i = 0; i < 8; i++) {
+	var f = fns[i % 4];
+	r[r.length] = f(i, 2);
+}
+var r1 = r.join(",") == "2,2,4,103,6,10,8,107";
+
+var g = add;
+var s = 0;
+for (var i = 0; i < 4; i++) {
+	s += g(i, 1);
+	if (i == 1) g = mul;
+}
+var r2 = s == 1 + 2 + 2 + 3;
+
+var r3 = count(1, 2, 3) == 3 && count() == 0 && missing(1) == "undefined" && def(5) == 15;
+var r4 = add(add(1, 2), add(3, 4)) == 10;
+
+var notFn = 5, caught = false;
+for (var i = 0; i < 2; i++) {
+	try { notFn(); } catch (e) { caught = e instanceof TypeError; }
+}
+
+result = r1 && r2 && r3 && r4 && caught;
@@ -0,0 +1,18 @@
+// Math and String natives use the fast calling convention - prototype and static forms
+
+var r1 = "abc".charAt(1) == "b" && String.charAt("abc", 2) == "c" && String.charAt("abc") == "a";
+var r2 = "ab".concat("c", "d") == "abcd" && String.concat("ab", "c", "d") == "abcd";
+var r3 = "hello".slice(1, -1) == "ell" && String.slice("hello", -3) == "llo";
+var r4 = "hello".substring(3, 1) == "el" && String.substring("hello", 3, 1) == "el" && String.substring("hello", 2) == "llo";
+var r5 = "hello".substr(1, 2) == "el" && String.substr("hello", 1) == "ello";
+var r6 = "a-b-c".replace("-", function(m) { return "+"; }) == "a+b-c" && "a,b,c".split(",").length == 3;
+var threw = false;
+try { String.prototype.charAt.call(undefined, 0); } catch(e) { threw = e instanceof TypeError; }
+var r7 = threw;
+var r8 = Math.abs(-3) == 3 && Math.max(1, 5, 2) == 5 && Math.min() == Infinity && Math.pow(2, 10) == 1024;
+var r9 = isNaN(Math.range(5, 3, 1)) && Math.range(0, 1, 3) == 1 && isNaN(Math.pow(1, Infinity)) && Math.sinh(2) > 3.6;
+// the replacer is called like a plain function - this is the global object
+var global = this;
+var r10 = "ab".replace("a", function(m) { return this === global ? "G" : "X"; }) == "Gb";
+
+result = r1 && r2 && r3 && r4 && r5 && r6 && r7 && r8 && r9 && r10;
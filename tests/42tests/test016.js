@@ -0,0 +1,16 @@
+// typed C++ natives registered by run_tests through the variadic addNative
+
+if (typeof typedMulAdd == "undefined") {
+	result = 1; // built without C++11
+} else {
+	var r1 = typedMulAdd(1.5, 4, 2) == 8 && typedMulAdd(1) == 0 && isNaN(typedMulAdd(undefined, 1, 1)) && typedMulAdd("2", "3", "1") == 7;
+	var r2 = typedRepeat("ab", 3) == "ababab" && typedRepeat(1, 2) == "11" && typedRepeat("x") == "";
+	var r3 = typedIsUndefined() === true && typedIsUndefined(null) === false;
+	typedCounterReset();
+	var r4 = typedCounterAdd(3) == 3 && typedCounterAdd(2) == 5 && typedCounterIsOdd() === true;
+	var r5 = typedCounterReset() === undefined && typedCounterIsOdd() === false;
+	var sum = 0;
+	for (var i = 0; i < 10; i++) sum += typedMulAdd(i, 2, 1);
+	var r6 = sum == 100;
+	result = r1 && r2 && r3 && r4 && r5 && r6;
+}
@@ -0,0 +1,24 @@
+// Math functions are numeric intrinsics - call-sites compute them directly while Math.x is unmodified
+
+var s = 0;
+for (var i = 0; i < 20; i++) s += Math.floor(i / 3) + Math.abs(-i) + Math.max(i, 10);
+var r1 = s == 57 + 190 + 245;
+
+// the call-site notices a replaced function and notices the original again
+var orig = Math.floor, r = [];
+for (var i = 0; i < 6; i++) {
+	if (i == 2) Math.floor = function(x) { return "patched"; };
+	if (i == 4) Math.floor = orig;
+	r[r.length] = Math.floor(i + 0.5);
+}
+var r2 = r.join(",") == "0,1,patched,patched,4,5";
+
+// arguments are converted with valueOf, missing arguments are NaN, extra arguments are evaluated
+var calls = 0;
+var obj = { valueOf: function(x) { calls++; return 7.5; } };
+var r3 = Math.floor(obj) == 7 && calls == 1 && isNaN(Math.sqrt()) && Math.pow(2, 3, calls++) == 8 && calls == 2;
+var r4 = Math.max(1, 9, 3, 4, 5, 6) == 9 && Math.min.apply(null, [4, 2, 8]) == 2 && Math.abs.call(null, -2) == 2;
+var m = Math.round;
+var r5 = m(2.5) == 3 && Math.sign(-0.5) == -1;
+
+result = r1 && r2 && r3 && r4 && r5;
@@ -0,0 +1,8 @@
+// require executes a file in the scope of the caller (run_tests -C loads it from the code cache)
+
+var ret = require("tests/42tests/test018.module.js");
+var g = moduleGenerator(3), gen = 0;
+for (var i = 0; i < 3; i++) gen += g.next();
+
+result = ret == 0.5 + 3 + 3 + 6 && moduleName == "module" && moduleFirst == 1 &&
+	gen == 3 && moduleArrow(2) == 6 && moduleTry() == 7 && moduleFinally;
@@ -0,0 +1,23 @@
+// module for test018 - uses every kind of token data
+function moduleSum(list) {
+	var sum = 0.5;
+	for (var i in list) sum += list[i];
+	for each (var v in list) sum += v;
+	return sum;
+}
+var moduleObject = { name: "module", values: [1, 2.25, 3], get twice() { return this.values.length * 2; } };
+var { name: moduleName, values: [ moduleFirst ] } = moduleObject;
+function moduleGenerator(n) { for (let i = 0; i < n; i++) yield i; }
+var moduleArrow = x => x * 3;
+function moduleTry() {
+	try {
+		throw { code: 7 };
+	} catch ({ code }) {
+		return code;
+	} finally {
+		moduleFinally = true;
+	}
+}
+var moduleFinally = false;
+label: do { break label; } while (true);
+moduleSum([1, 2]) + moduleObject.twice;
@@ -0,0 +1,11 @@
+// require caches the exports of a CommonJS module (a file that uses exports or module.exports)
+
+var loads = 0;
+function handler() { return require("tests/42tests/test019.module.js"); }
+var a = handler(), b = handler();
+var n1 = a.next(), n2 = b.next();
+var isPrivate = false;
+try { count; } catch(e) { isPrivate = true; }
+
+result = a === b && loads == 1 && n1 == 1 && n2 == 2 &&
+	isPrivate && a.id.indexOf("test019.module.js") >= 0;
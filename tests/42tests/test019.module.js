@@ -0,0 +1,7 @@
+// CommonJS module for test019 - executed once, require returns the cached exports
+var count = 0;
+loads++;
+module.exports = {
+	next: function() { return ++count; },
+	id: module.id
+};
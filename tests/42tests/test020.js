@@ -0,0 +1,17 @@
+// eval and Function reuse the compiled code of a source text (eval cache)
+
+var sum = 0, fncs = [];
+for(var i = 0; i < 100; i++) {
+	sum += eval("i * 2 + 1");
+	fncs[i] = new Function("a", "b", "return a * b + " + (i % 3) + ";");
+}
+var f = 0;
+fncs[0].tag = 1; // the functions of the same source text are distinct objects
+for(var i = 0; i < 100; i++) f += fncs[i](i, 2);
+var inner = 0;
+function evalHere(x) { return eval("var y = x + 1; y * 10"); }
+for(var i = 0; i < 10; i++) inner += evalHere(i);
+var syntaxErrors = 0;
+for(var i = 0; i < 3; i++) try { eval("1 +"); } catch(e) { syntaxErrors++; }
+
+result = sum == 10000 && f == 9999 && inner == 550 && syntaxErrors == 3 && fncs[3].tag === undefined;
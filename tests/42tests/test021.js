@@ -0,0 +1,14 @@
+// lexer: comments, line breaks, string escapes and identifiers that start with a reserved word
+
+var a = 1 /*/ still a comment */ + 2; /** two **/ var b = 3; // line comment
+var s = "tab\tx" + 'q\x41\101' + "con\
+tinued";
+var instanceof_ = 4, functions = 5, $in = 6, _do = 7, in2 = 8;
+var lines = (function() {
+	/* a block comment
+	   over lines */
+	return 1;
+})();
+
+result = a == 3 && b == 3 && s == "tab\tx" + "qAA" + "continued" &&
+	instanceof_ + functions + $in + _do + in2 == 30 && lines == 1;
@@ -0,0 +1,32 @@
+// function bodies with braces in strings, regular expressions and comments (run_tests -l tokenizes them on the first call)
+
+function braces(s) {
+	var open = "{{", close = '}'; // }
+	/* } */
+	var re = /\}+/g;
+	return s.replace(re, close) + open.length;
+}
+
+function counter(start) {
+	var n = start;
+	return {
+		next: function() { return ++n; },
+		peek: function() { return eval("n"); }
+	};
+}
+
+function gen(n) { for(var i=0; i<n; i++) { if(i == 1) continue; yield i; } }
+
+var outer = 10;
+function nested(a) {
+	function inner(b) { return function(c) { return a + b + c + outer; }; }
+	return inner(a * 2);
+}
+
+var c = counter(5);
+c.next(); c.next();
+var g = "";
+for(var v in gen(4)) g += v;
+
+result = braces("a}}}b") == "a}b2" && c.peek() == 7 && g == "023" &&
+	nested(1)(3) == 16 && nested.toString().indexOf("outer") > 0;
@@ -0,0 +1,23 @@
+// toString returns the text of a function as written in the source
+
+function add(a, b) {
+	// the comment and the formatting are kept
+	return a   +   b;
+}
+var expr = function (x) { return "}" + x; }, semi = 1;
+var obj = { method: function() { var s = 'a' /* b */; return s; } };
+function outer() {
+	function inner(y) { return y * 2; }
+	return inner;
+}
+var f = new Function("a", "b", "return a * b;");
+var arrow = x => x + 1 * 2;
+var arrowBlock = (a, b) => { return a*b; };
+var arrowObject = ({p}) => p;
+
+result = add.toString().replace(/\r/g, "") == "function add(a, b) {\n\t// the comment and the formatting are kept\n\treturn a   +   b;\n}" &&
+	expr.toString() == "function (x) { return \"}\" + x; }" &&
+	obj.method.toString() == "function() { var s = 'a' /* b */; return s; }" &&
+	outer().toString() == "function inner(y) { return y * 2; }" &&
+	arrow.toString() == "x => x + 1 * 2" && arrowBlock.toString() == "(a, b) => { return a*b; }" && arrowObject.toString() == "({p}) => p" &&
+	f(3, 4) == 12 && ("" + add).indexOf("a   +   b") > 0 && Math.max.toString().indexOf("[native code]") > 0;
@@ -0,0 +1,23 @@
+// constant folding - the folded results must match the unfolded semantics
+
+var day = 60*60*24;
+var str = "a" + "b" + 1 + 2;
+var num = 1 + 2 + "c";
+var not = !true;
+var type = typeof 1;
+var negZero = 1 / -0;
+var nan = 0 / 0;
+var prec = 10 - 2 + 3;
+var x = 4;
+var mixed = 1 + 2 * x;
+var cond = true ? "yes" : "no";
+var shifted = (1 << 4) | 3;
+
+var branch = 0;
+if(false) branch = 1; else branch = 2;
+if(0) { var hoisted = 1; }
+
+result = day == 86400 && str == "ab12" && num == "3c" && not === false &&
+	type == "number" && negZero == -Infinity && isNaN(nan) && nan != nan &&
+	prec == 11 && mixed == 9 && cond == "yes" && shifted == 19 &&
+	branch == 2 && hoisted === undefined;
@@ -0,0 +1,40 @@
+// switch with literal case labels jumps through a table - same results as the sequential compare
+
+function kind(v) {
+	var r = "";
+	switch(v) {
+		case 1: r += "one";
+		case 2: r += "two"; break;
+		case -1: r += "minus"; break;
+		case 2.5: r += "float"; break;
+		case "1": r += "string"; break;
+		default: r += "default";
+		case 0: r += "zero"; break;
+		case 1: r += "never";
+	}
+	return r;
+}
+function noDefault(v) {
+	switch(v) { case "a": return "A"; case "b": let x = "B"; return x; }
+	return "none";
+}
+var three = 3;
+function variable(v) {
+	switch(v) { case three: return "three"; case 4: return "four"; default: return "other"; }
+}
+var big = 0;
+for(var i = 0; i < 40; i++) {
+	switch(i % 8) {
+		case 0: case 1: big += 1; break;
+		case 2: big += 10; break;
+		case 7: big += 100;
+	}
+}
+if(true) { switch("x") { case "x": var hit = true; } }
+
+result = kind(1) == "onetwo" && kind(2) == "two" && kind(-1) == "minus" && kind(2.5) == "float" &&
+	kind("1") == "string" && kind(0) == "zero" && kind(-0) == "zero" && kind(7) == "defaultzero" &&
+	kind(0/0) == "defaultzero" && kind(true) == "defaultzero" && kind([1]) == "defaultzero" &&
+	noDefault("a") == "A" && noDefault("b") == "B" && noDefault("c") == "none" && noDefault(1) == "none" &&
+	variable(3) == "three" && variable(4) == "four" && variable("3") == "other" &&
+	big == 560 && hit;
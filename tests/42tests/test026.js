@@ -0,0 +1,10 @@
+// a closure created in a function that uses eval keeps the whole scope - eval can add names later
+
+function o1() { var f = function() { return y; }; eval("var y = 5"); return f(); }
+function o2() {
+	var g;
+	{ let z = 1; g = function() { return function() { return w + z; }; }; }
+	eval("var w = 2");
+	return g()();
+}
+result = o1() == 5 && o2() == 3;
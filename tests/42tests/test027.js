@@ -0,0 +1,6 @@
+// require runs a script-style module in the caller's scope and returns its value
+// even if it uses properties named exports or declares its own exports
+
+var value = require("tests/42tests/test027.module.js");
+
+result = value == "done" && helper == 42 && o.exports == 1 && p.exports == 2 && exports.own == 3;
@@ -0,0 +1,10 @@
+// a script-style module - the .exports properties don't make it a CommonJS module
+var helper = 42;
+var o = {};
+o.exports = 1;
+var p = { exports: 2, module: 3 };
+p.module.exports;
+// a declared exports is the script's own variable
+var exports = {};
+exports.own = 3;
+"done";
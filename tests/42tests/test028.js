@@ -0,0 +1,17 @@
+// the Var of a literal is shared by its evaluations - a primitive ignores an assignment to __proto__ like to any other property
+
+var a = "k";
+a.__proto__ = { z:1 };
+var b = "k";
+var r1 = b.z === undefined && typeof "k".charAt == "function" && a.z === undefined;
+
+var seen = "";
+for(var i=0; i<2; i++) {
+	var s = "lit", n = 7;
+	seen += s.z + "," + n.z + ";";
+	s.__proto__ = { z:1 };
+	n.__proto__ = { z:7 };
+}
+var r2 = seen == "undefined,undefined;undefined,undefined;" && "lit".charAt(0) == "l";
+
+result = r1 && r2;